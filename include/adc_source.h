@@ -0,0 +1,81 @@
+#ifndef ADC_SOURCE_H
+#define ADC_SOURCE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "decimator.h"
+
+// Acquisition backends (select with ACQUISITION_MODE in config.h)
+#define ACQUISITION_TIMER 0   // Hardware timer ISR -> task notification -> analogRead(), one wakeup per sample
+#define ACQUISITION_DMA   1   // I2S ADC continuous DMA, hardware paced, one wakeup per DMA frame
+#define ACQUISITION_OVERSAMPLED 2  // DMA + CIC/FIR decimation chain, extra resolution and alias rejection
+
+// Resolution of the samples in the ring buffer. Amplitude thresholds are
+// given in 12-bit ADC units and scaled by ADC_SAMPLE_SCALE.
+#if ACQUISITION_MODE == ACQUISITION_OVERSAMPLED
+#define ADC_SAMPLE_BITS (12 + DECIMATOR_EXTRA_BITS)
+#else
+#define ADC_SAMPLE_BITS 12
+#endif
+#define ADC_SAMPLE_SCALE (1 << (ADC_SAMPLE_BITS - 12))
+
+// Spectral peak magnitudes also grow with the window length, so
+// AMPLITUDE_THRESHOLD is given for a 512-sample window (50/60 Hz profiles)
+#define SPECTRUM_AMPLITUDE_THRESHOLD ((float)AMPLITUDE_THRESHOLD * ADC_SAMPLE_SCALE * ANALYSIS_SIZE / 512)
+
+// Most samples a single read() can return (sizes the sampler's frame buffer)
+#define ADC_SOURCE_MAX_SAMPLES (ADC_DMA_FRAME_SAMPLES / ADC_DMA_OVERSAMPLE)
+
+// Delivers samples at SAMPLING_FREQUENCY to the sampler task. begin() and
+// read() are both called from the sampler task, so a backend may bind to
+// the calling task (e.g. as target of its ISR).
+class AdcSource {
+public:
+    virtual ~AdcSource() {}
+    virtual void begin() = 0;
+    // Blocks until at least one sample is available, returns the count
+    virtual size_t read(uint16_t* samples, size_t maxSamples) = 0;
+    virtual bool getLoad(AcquisitionLoad* load) { return false; }  // Only backends with per-frame processing
+    virtual double gainAt(double frequency) { return 1.0; }       // Amplitude response of the backend's filtering
+    static AdcSource* create();  // Backend selected by ACQUISITION_MODE
+};
+
+// Timer ISR only notifies; analogRead() & friends are not ISR-safe (flash
+// resident, take locks) and crash/hang when WiFi does flash writes.
+class TimerAdcSource : public AdcSource {
+public:
+    void begin() override;
+    size_t read(uint16_t* samples, size_t maxSamples) override;
+
+private:
+    static void IRAM_ATTR onTimer();
+    static TaskHandle_t samplerTask;
+    hw_timer_t* timer{nullptr};
+};
+
+// The I2S peripheral clocks the ADC and DMAs full frames into memory. The
+// I2S ADC mode can't run as slow as 512 Hz, so it samples at
+// SAMPLING_FREQUENCY * ADC_DMA_OVERSAMPLE and each group is averaged.
+class DmaAdcSource : public AdcSource {
+public:
+    void begin() override;
+    size_t read(uint16_t* samples, size_t maxSamples) override;
+    double gainAt(double frequency) override;
+
+protected:
+    size_t readFrame();  // Blocks for one full DMA frame, returns raw sample count
+    uint16_t frame[ADC_DMA_FRAME_SAMPLES];
+};
+
+// Same DMA stream, decimated by the CIC/FIR chain instead of averaged
+class OversampledAdcSource : public DmaAdcSource {
+public:
+    size_t read(uint16_t* samples, size_t maxSamples) override;
+    bool getLoad(AcquisitionLoad* load) override;
+    double gainAt(double frequency) override;
+
+private:
+    Decimator decimator;
+};
+
+#endif // ADC_SOURCE_H
@@ -0,0 +1,91 @@
+#ifndef ALARM_ENGINE_H
+#define ALARM_ENGINE_H
+
+#include <Arduino.h>
+#include <sys/time.h>
+#include "config.h"
+
+struct FrequencyAlert;
+
+// Alarm types in priority order (most severe first)
+enum AlarmType : uint8_t {
+    ALARM_AMPL,
+    ALARM_ROCOF,
+    ALARM_LEVEL2_EMERGENCY,
+    ALARM_LEVEL1_EMERGENCY,
+    ALARM_ALERT_RANGE,
+    ALARM_TYPES,
+    ALARM_NONE = ALARM_TYPES
+};
+
+enum AlarmPhase : uint8_t {
+    ALARM_EVENT_START,
+    ALARM_EVENT_UPDATE,
+    ALARM_EVENT_END
+};
+
+// Rule groups: rules of one group judge the same quantity at rising
+// thresholds and escalate, only the most severe of them is active
+enum AlarmGroup : uint8_t {
+    ALARM_GROUP_AMPLITUDE,
+    ALARM_GROUP_ROCOF,
+    ALARM_GROUP_DEVIATION
+};
+
+// One row of the rule table. severity() is the measured value relative to
+// the entry threshold: the event starts after severity >= 1 held for
+// enterMs and ends after severity < ALARM_EXIT_RATIO held for exitMs.
+struct AlarmRule {
+    const char* name;       // MQTT alertType
+    const char* label;      // LCD prefix
+    const char* format;     // LCD value format, at most 10 characters
+    AlarmGroup group;
+    float (*severity)(const FrequencyAlert& alert, float* value);
+    uint16_t enterMs;
+    uint16_t exitMs;
+    uint16_t buzzerHz;
+};
+
+extern const AlarmRule alarmRules[ALARM_TYPES];
+const char* alarmName(AlarmType type);
+const char* alarmPhaseName(AlarmPhase phase);
+
+struct AlarmEvent {
+    AlarmType type;
+    AlarmPhase phase;
+    timeval start;          // Slice in which the condition first held
+    uint32_t durationMs;    // From start to this record
+    float value;            // Current value (signed Hz deviation, Hz/s or amplitude)
+    float peak;             // Value at the highest severity so far
+    char message[LCD_COLS + 1];  // One LCD row
+};
+
+// Runs every rule on each interpreted slice. Events of different groups can
+// be active at once; within a group a more severe rule that starts ends the
+// lesser event, and a lesser rule that qualifies again while the severe one
+// is clearing takes over. Each event emits a start, an update every
+// ALARM_UPDATE_MS while active, and an end with peak and duration.
+class AlarmEngine {
+public:
+    AlarmEngine();
+    uint8_t update(const FrequencyAlert& alert, AlarmEvent* events);  // Up to ALARM_TYPES events
+    AlarmType mostSevere() const;
+
+private:
+    struct RuleState {
+        bool active;
+        bool pending;             // Entry condition holds, qualifier running
+        bool clearing;            // Exit condition holds, qualifier running
+        unsigned long since;      // Start of the running qualifier
+        unsigned long startMillis;
+        unsigned long lastReport;
+        timeval start;
+        float peakSeverity;
+        float peak;
+    };
+    RuleState state[ALARM_TYPES];
+    bool superseded(uint8_t i) const;
+    void emit(AlarmType type, AlarmPhase phase, unsigned long now, float value, AlarmEvent* event);
+};
+
+#endif // ALARM_ENGINE_H
@@ -0,0 +1,36 @@
+#ifndef COMPACT_LAYOUT_H
+#define COMPACT_LAYOUT_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Storage types and buffer sizes that depend on COMPACT_LAYOUT. Computation
+// stays in double where it matters (phase, regression); only spectra and
+// stored results shrink.
+//   spectrum_t: magnitude scratch of the spectrum engines. arduinoFFT works
+//               in place on double, so it keeps double.
+//   result_t:   FrequencyAnalysis values. float resolves 4 uHz at 50 Hz,
+//               far below the estimator noise.
+#if COMPACT_LAYOUT && !(SPECTRUM_ENGINE == 0 && FFT_KERNEL == 0)
+typedef float spectrum_t;
+#else
+typedef double spectrum_t;
+#endif
+
+#if COMPACT_LAYOUT
+typedef float result_t;
+#else
+typedef double result_t;
+#endif
+
+constexpr uint32_t nextPowerOfTwo(uint32_t x, uint32_t p = 1) { return p >= x ? p : nextPowerOfTwo(x, p << 1); }
+
+// Sample ring: RING_BUFFER_SIZE, or in the compact layout just what the
+// analysis window plus the slice slots can reference
+#if COMPACT_LAYOUT
+constexpr uint32_t kRingSize = nextPowerOfTwo((SLICE_SLOTS - 1) * PHASE_BLOCK_SIZE + ANALYSIS_SIZE);
+#else
+constexpr uint32_t kRingSize = RING_BUFFER_SIZE;
+#endif
+
+#endif // COMPACT_LAYOUT_H
@@ -21,6 +21,13 @@
 #define MQTT_PORT 1883                     // Standard MQTT port (1883=unencrypted, 8883=encrypted)
 #define MQTT_USERNAME "your_username"      // MQTT broker authentication username
 #define MQTT_PASSWORD "your_password"      // MQTT broker authentication password
+#define PAYLOAD_FORMAT 0                   // Measurements as 0 = JSON on MQTT_TOPIC, 1 = packed binary on MQTT_TOPIC/bin (~73 B), 2 = batches on MQTT_TOPIC/batch
+#define BATCH_SIZE 16                      // Measurements per batch (PAYLOAD_FORMAT 2), sent early while an alarm is active
+#define BATCH_MAX_LATENCY_MS 5000          // Oldest measurement in a batch waits at most this long
+#define REPORT_MODE 0                      // 0 = every result, 1 = change-driven (swinging door), not with PAYLOAD_FORMAT 2
+#define REPORT_FREQ_DEADBAND 0.002         // Hz: reported series stays this close to every result (REPORT_MODE 1)
+#define REPORT_AMP_DEADBAND 50.0           // Amplitude counts, same for the amplitude
+#define REPORT_HEARTBEAT_MS 10000          // Report at least this often while nothing changes
 
 // Configuration state flags
 // Runtime checks to ensure proper configuration
@@ -32,12 +39,22 @@
 #define WIFI_FORCE_RECONNECT_MS 60000   // Force a full WiFi re-association after this long offline
 #define MQTT_RETRY_INTERVAL_MS 30000    // Minimum time between (blocking) MQTT/TLS connect attempts
 #define NET_TIMEOUT_S 10                // Socket / TLS handshake timeout in seconds
-#define WDT_TIMEOUT_S 60                // Task watchdog: reboot if loop() stalls this long
+#define WDT_TIMEOUT_S 60                // Task watchdog: reboot if loop() or the network task stalls this long
+#define NET_POLL_MS 50                  // Network task wake-up for keep-alive and reconnects when idle
+#define NET_QUEUE_BYTES 8192            // Outbound MQTT message ring (power of two), filled only by loop()
+#define NET_BULK_SHARE 50               // % of the ring backfill and capture export may use (they retry later)
+#define NET_EVENT_RESERVE 1024          // Bytes of the ring only alarm events may use; live data is dropped before
+#define NET_REPORT_MS 60000             // Queue depth and drop counters to <MQTT_TOPIC>/net
 
 // NTP Configuration
 // Time synchronization settings for accurate timestamping
 #define NTP_SERVER "pool.ntp.org"          // NTP server pool for time synchronization
 #define TIME_ZONE "CET-1CEST,M3.5.0,M10.5.0/3"  // Central European Time with automatic DST
+#define TIMEBASE_SYNC_INTERVAL_MS 900000  // SNTP update interval; every update is a point for the drift regression
+#define TIMEBASE_POINTS 8                 // SNTP updates kept in the regression (8 x 15 min = 2 h)
+#define TIMEBASE_MIN_SPAN_S 1800          // Regression span before the ppm estimate is applied
+#define TIMEBASE_STEP_MS 100              // Larger residual = clock step or sampling gap, regression restarts
+#define TIMEBASE_MAX_PPM 100              // Plausibility limit of the crystal error estimate
 
 // Hardware Pin Configuration
 // ESP32 GPIO assignments for various components
@@ -51,22 +68,106 @@
 #define BUZZER_PIN 25        // Alert buzzer output
 #define BUTTON_DEBOUNCE_MS 500  // Button debounce delay to prevent multiple triggers
 
+// Grid Profile
+// Nominal frequency, sampling rate, window geometry and search band (see grid_profile.h)
+#define GRID_PROFILE 0             // 0 = 50 Hz (Europe), 1 = 60 Hz (North America), 2 = 16.7 Hz railway
+
+// Acquisition Configuration
+// How samples get from the ADC into the analyzer's ring buffer
+#define ACQUISITION_MODE 0         // 0 = timer ISR + analogRead() per sample, 1 = I2S ADC continuous DMA, 2 = DMA + CIC/FIR decimation
+#define ADC_DMA_CHANNEL ADC1_CHANNEL_6  // I2S ADC channel of ADC_PIN (GPIO34 = ADC1_CH6)
+#define ADC_DMA_OVERSAMPLE 16      // DMA raw rate = SAMPLING_FREQUENCY * this, averaged down (I2S ADC can't clock 512 Hz)
+#define ADC_DMA_FRAME_SAMPLES 512  // Raw samples per DMA buffer = one sampler wakeup (512 => 16 wakeups/s)
+#define DECIMATOR_FIR_TAPS 48      // Mode 2: polyphase FIR length (decimates the CIC output by 2, fc = 256 Hz)
+#define DECIMATOR_EXTRA_BITS 3     // Mode 2: resolution kept beyond the 12-bit ADC (samples become 15 bit)
+#define DECIMATOR_BUDGET_PERCENT 1 // Mode 2: CPU budget per DMA frame (% of frame period); overruns are counted and reported
+#define DECIMATOR_REPORT_MS 10000  // Mode 2: how often the decimator load is printed
+
 // Frequency Analysis Configuration
 // Signal processing parameters for accurate frequency measurement
-#define SAMPLING_FREQUENCY 512    // ADC sampling rate (Hz) - Nyquist frequency > 100Hz
-#define RING_BUFFER_SIZE 4096    // Circular buffer for continuous sampling (8 seconds)
-#define ANALYSIS_SIZE 512        // FFT window size (1 second of data)
-#define ANALYSIS_INTERVAL_MS 250 // Update rate for frequency calculations (4 Hz)
-#define AMPLITUDE_THRESHOLD 10000 // Minimum signal strength for valid measurement
+#define RING_BUFFER_SIZE 4096    // Circular buffer for continuous sampling (8 seconds at 512 Hz)
+#define COMPACT_LAYOUT 0         // 1 = float spectra/results and a ring sized to what the analysis reads (RING_BUFFER_SIZE ignored)
+#define SLICE_SLOTS 8            // Slice headers the analysis may lag behind the sampler (power of two, 8 blocks = 2 s)
+#define AMPLITUDE_THRESHOLD 10000 // Minimum spectral peak for a valid measurement (12-bit ADC, 512-sample window; scaled to the profile)
+#define SPECTRUM_ENGINE 0          // 0 = full 512-point FFT per slice, 1 = sliding DFT over the search bins only, 2 = zoom DFT of the search band
+#define ZOOM_BINS 64               // Grid points across the search band for SPECTRUM_ENGINE 2 (50 Hz profile: 10 Hz / 64 = 0.16 Hz)
+#define ZOOM_DECIMATION 16         // Zoom mix-down decimation factor (512 Hz -> 32 Hz baseband)
+#define FFT_KERNEL 1               // FFT for SPECTRUM_ENGINE 0: 0 = arduinoFFT (double), 1 = in-tree float32, 2 = in-tree Q15
+#define FFT_KERNEL_SELFTEST 0      // 1 = compare FFT_KERNEL against arduinoFFT at boot and print the error
+#define PHASE_MAG_THRESHOLD 2000  // Minimum block correlation magnitude for a valid phase measurement (~0.5*(N/2)*A with Hann)
+#define PHASE_MAX_DEVIATION 0.3f  // Max |fine - coarse| in Hz before a phase measurement is discarded (e.g. lost samples)
+#define HARMONIC_ANALYSIS 1        // 1 = harmonics and THD from the coarse spectrum (SPECTRUM_ENGINE 0 only)
+#define HARMONIC_MAX 5             // Highest harmonic evaluated (harmonics above Nyquist are reported as null)
+#define FREQ_FILTER 2              // 0 = none, 1 = legacy EMA (0.75/0.25, ~1 s lag), 2 = Kalman tracker (frequency + RoCoF, outlier rejection)
+#define KALMAN_FINE_NOISE_HZ 0.002     // Measurement sigma of a fine estimate at reference amplitude/quality
+#define KALMAN_COARSE_FACTOR 10        // Sigma multiplier for coarse-only slices
+#define KALMAN_REF_AMPLITUDE 100000    // Spectral peak amplitude above which the base sigma applies
+#define KALMAN_REF_QUALITY 0.02        // Quality metric below which the base sigma applies
+#define KALMAN_ROCOF_NOISE 0.01        // Process noise: RoCoF change, (Hz/s)^2 per second
+#define KALMAN_INITIAL_ROCOF 0.5       // RoCoF sigma (Hz/s) after (re)initialisation
+#define KALMAN_GATE 4                  // Innovation gate in sigmas
+#define HAMPEL_THRESHOLD 3             // Hampel test in scaled MADs (window of 5 raw estimates)
+#define SOGI_FLL 0                 // 1 = per-sample SOGI-FLL tracker in the sampler, reported as freqFll (diagnostic, not used for alarms)
+#define SOGI_FLL_K 0.7f            // SOGI damping (lower = more selective against harmonics, slower)
+#define SOGI_FLL_GAIN 20.0f        // Normalised FLL gain (higher = faster, more ripple from harmonics and noise)
+#define SOGI_DC_CUTOFF 1.0f        // ADC offset high-pass corner in Hz
+#define SOGI_MIN_AMPLITUDE 100     // Fundamental peak amplitude (12-bit ADC counts) for a locked output
 
 // Frequency Interpretation Configuration
 // All thresholds according to ENTSO-E Operation Handbook, Policy 1
-#define TARGET_FREQUENCY 50.000f          // Nominal frequency of the Continental European power grid (Hz)
 #define STANDARD_RANGE_THRESHOLD 0.050f   // Normal operation range threshold (±50mHz). If exceeded, monitoring required
 #define ALERT_RANGE_THRESHOLD 0.200f      // Alert state threshold (±200mHz). Triggers system operator awareness
 #define LEVEL1_EMERGENCY_THRESHOLD 0.200f // Level 1 Emergency threshold (±800mHz). System stressed, corrective actions needed
 #define LEVEL2_EMERGENCY_THRESHOLD 0.800f // Level 2 Emergency threshold (±2500mHz). High risk of grid collapse
-#define ROCOF_THRESHOLD 0.500f           // Rate of Change of Frequency threshold (±500mHz/s). Indicates dynamic stability issues
+
+// RoCoF Windows
+// Least-squares slopes over several windows, updated per slice (multiples of the 250 ms slice period)
+#define ROCOF_WINDOWS 3                              // Number of windows
+#define ROCOF_WINDOW_MS {500, 2000, 10000}           // Window lengths in ms: trip detection ... slow drift
+#define ROCOF_WINDOW_THRESHOLDS {1.00f, 0.50f, 0.10f} // Alarm threshold per window in Hz/s. Indicates dynamic stability issues
+
+// Alarm Events
+// Each rule starts an event after its threshold held ALARM_ENTER_MS and ends it after
+// the value stayed below ALARM_EXIT_RATIO * threshold for ALARM_EXIT_MS
+#define ALARM_ENTER_MS 1000           // Minimum duration before an event starts
+#define ALARM_EXIT_MS 3000            // Minimum duration below the exit level before it ends
+#define ALARM_EXIT_RATIO 0.8f         // Exit level as fraction of the entry threshold (hysteresis)
+#define ALARM_UPDATE_MS 10000         // Interval of update records while an event is active
+
+// Streaming Statistics
+// Per-interval summaries of frequency and |deviation| on <MQTT_TOPIC>/stats
+#define STREAM_STATS 1                // 0 = off, 1 = aggregate on the device
+#define STATS_INTERVAL_COUNT 2        // Number of intervals
+#define STATS_INTERVALS {60, 900}     // Interval lengths in s, aligned to the clock (1 min, 15 min)
+#define STATS_QUANTILE_COUNT 5        // Number of quantiles (P-square sketch, ~100B each per series)
+#define STATS_QUANTILES {0.01f, 0.05f, 0.50f, 0.95f, 0.99f}
+#define RAW_PUBLISH_DIVIDER 1         // Publish every Nth result on MQTT_TOPIC (4 = 1 Hz); alarms always publish
+
+// Disturbance Recorder
+// Raw samples around each alarm start, exported as COMTRADE (.cfg/.dat) to <MQTT_TOPIC>/capture/<id>/...
+#define DISTURBANCE_RECORDER 1        // 0 = off, 1 = capture on every alarm event start
+#define RECORDER_PRE_MS 4000          // Pre-trigger window in ms (whole 250 ms slices)
+#define RECORDER_POST_MS 4000         // Post-trigger window in ms; 2 buffers of 1.5 B per sample (~12 KB at 8 s)
+#define RECORDER_CHUNK_RECORDS 64     // .dat records (12 B each) per MQTT message, must fit MQTT_MAX_PACKET_SIZE
+
+// Store-and-forward Journal
+// Measurements taken while MQTT is down go to flash (LittleFS, "spiffs" partition) and are replayed to <MQTT_TOPIC>/backfill
+#define MEASUREMENT_JOURNAL 1         // 0 = off (measurements are lost while offline), 1 = journal on LittleFS
+#define JOURNAL_PAGE_SIZE 4096        // Bytes per flash write (one LittleFS block, 55 records of 73 B), held in RAM
+#define JOURNAL_PAGES 192             // Ring of page files (768 KB, ~44 min of 250 ms results); oldest page is overwritten
+#define JOURNAL_BACKFILL_RECORDS 12   // Records per backfill message, must fit MQTT_MAX_PACKET_SIZE
+#define JOURNAL_BACKFILL_MS 250       // Minimum time between backfill messages (12 x 4/s = 12x real time)
+#define JOURNAL_STATUS_MS 60000       // Journal depth and oldest unsent time to <MQTT_TOPIC>/journal
+
+// Live Server
+// HTTP status and WebSocket stream for LAN clients, independent of the MQTT broker
+#define LIVE_SERVER 1                 // 0 = off, 1 = on LIVE_SERVER_PORT: / page, /status JSON, /ws measurements (/ws?raw=1 adds ADC frames)
+#define LIVE_SERVER_PORT 80
+#define LIVE_MAX_CLIENTS 4            // Concurrent HTTP/WebSocket clients (~2.6 KB static each)
+#define LIVE_CLIENT_BUFFER 2048       // Send buffer per client; a frame that does not fit is dropped for that client only
+#define LIVE_STALL_MS 10000           // Disconnect a client whose send buffer has not drained (or request not arrived) for this long
+#define LIVE_STATUS_ALARMS 8          // Newest alarm records in /status
+#define LIVE_RAW_FRAMES 1             // 1 = analysis task hands the newest block of each slice to /ws?raw=1 clients
 
 // Display Configuration
 // LCD and alarm system parameters
@@ -74,13 +175,26 @@
 #define LCD_COLS 20                   // Display width in characters (20x4 LCD)
 #define LCD_ROWS 4                    // Display height in characters
 #define LCD_PIXELS 100                // Display width in pixels (for graphics)
-#define MAX_ALARMS      64            // Maximum number of stored alarm events (ring buffer, ~100B each)
-#define MAX_ALARM_INTERVAL_MS 5000    // Minimum time between new alarms (prevent spam)
+#define MAX_ALARMS      64            // Maximum number of stored alarm events (ring buffer, ~32B each)
 #define BUZZER_DURATION_MS 600000     // How long the buzzer sounds after a new alarm (history stays until mute)
 #define DISPLAY_REFRESH_MS 500        // Screen update interval (2 Hz refresh rate)
 
+// Task Configuration
+// Analysis runs in its own task; display and network consume its results from queues
+#define ANALYSIS_TASK_PRIORITY 5      // Below the sampler (10), above loop() (1)
+#define ANALYSIS_TASK_CORE 1          // Same core as the sampler; WiFi/lwIP run on core 0
+#define ANALYSIS_TASK_STACK 6144      // Analysis task stack in bytes
+#define NET_TASK_PRIORITY 2           // WiFi/MQTT/TLS task, above loop() (1)
+#define NET_TASK_CORE 0               // With WiFi/lwIP, away from acquisition and analysis
+#define NET_TASK_STACK 8192           // TLS handshake runs on this stack
+#define TRANSMIT_QUEUE_LENGTH 16      // Results buffered for MQTT while loop() is blocked (16 x 250 ms = 4 s)
+#define ALARM_QUEUE_LENGTH 16         // Alarm events buffered for display and MQTT (>= start and end of every alarm type)
+#define STATS_QUEUE_LENGTH 4          // Closed statistics intervals buffered for MQTT
+
 // Timer Configuration
 // ESP32 timer settings for precise sampling
 #define CPU_FREQUENCY_MHZ 160       // ESP32 CPU clock speed (160MHz is plenty; sampling is timer-driven)
 
+#include "grid_profile.h"
+
 #endif // CONFIG_H
\ No newline at end of file
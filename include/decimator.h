@@ -0,0 +1,55 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define DECIMATOR_CIC_ORDER 3
+#define DECIMATOR_FIR_FACTOR 2
+#define DECIMATOR_CIC_FACTOR (ADC_DMA_OVERSAMPLE / DECIMATOR_FIR_FACTOR)
+#define DECIMATOR_PHASE_TAPS (DECIMATOR_FIR_TAPS / DECIMATOR_FIR_FACTOR)
+#define DECIMATOR_MAX_OUTPUTS (ADC_DMA_FRAME_SAMPLES / ADC_DMA_OVERSAMPLE)
+
+// Per-frame cost of the decimation chain, in CPU cycles
+struct AcquisitionLoad {
+    uint32_t lastCycles;
+    uint32_t peakCycles;     // Since the previous getLoad()
+    uint32_t budgetCycles;   // DECIMATOR_BUDGET_PERCENT of one frame period
+    uint32_t overruns;       // Frames that exceeded the budget
+};
+
+// Oversampled ADC -> SAMPLING_FREQUENCY in two stages, one DMA frame at a time:
+//  1. CIC (order 3) decimating by ADC_DMA_OVERSAMPLE / 2, integer only;
+//     its nulls at multiples of 1024 Hz remove everything that would fold
+//     onto the low band.
+//  2. Blackman-windowed FIR low-pass (fc = SAMPLING_FREQUENCY / 2)
+//     decimating by 2, split into its two polyphase branches so every tap
+//     runs once per output sample over contiguous history.
+// Output keeps DECIMATOR_EXTRA_BITS of the gained resolution (ADC_SAMPLE_BITS).
+class Decimator {
+public:
+    Decimator();
+    size_t process(const uint16_t* raw, size_t count, uint16_t* out);  // count = whole groups of ADC_DMA_OVERSAMPLE
+    void getLoad(AcquisitionLoad* load);
+    double response(double frequency);  // Magnitude response of the whole chain (1 at DC)
+
+private:
+    // CIC state (unsigned: wrap-around is intended and cancels in the combs)
+    uint32_t integrator[DECIMATOR_CIC_ORDER]{0};
+    uint32_t comb[DECIMATOR_CIC_ORDER]{0};
+    uint16_t cicPhase{0};
+
+    // Polyphase FIR: even taps see even CIC outputs, odd taps odd ones
+    float evenTaps[DECIMATOR_PHASE_TAPS];
+    float oddTaps[DECIMATOR_PHASE_TAPS];
+    float evenHistory[DECIMATOR_PHASE_TAPS - 1 + DECIMATOR_MAX_OUTPUTS]{0};
+    float oddHistory[DECIMATOR_PHASE_TAPS + DECIMATOR_MAX_OUTPUTS]{0};
+    float outputScale{1};
+
+    volatile uint32_t lastCycles{0};
+    volatile uint32_t peakCycles{0};
+    volatile uint32_t overruns{0};
+    uint32_t budgetCycles{0};
+};
+
+#endif // DECIMATOR_H
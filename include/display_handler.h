@@ -63,6 +63,17 @@ static byte horzLine[8] = {
   B00000,
 };
 
+#define LCD_GLYPHS 8                  // HD44780 CGRAM slots
+#define LCD_GLYPH_BAR 7               // Slot redefined for the partial bar cell
+
+// Alarm list entry: one per event, message updated until the event ends
+struct AlarmRecord {
+    time_t time;
+    AlarmType type;
+    char message[LCD_COLS + 1];
+};
+static_assert(sizeof(AlarmRecord::message) == sizeof(AlarmEvent::message), "Alarm list entries hold the whole event message");
+
 class DisplayHandler {
 public:
     DisplayHandler();  // Private constructor for singleton
@@ -71,14 +82,25 @@ public:
     void updateMqttStatus(bool status); 
     void updateNTPStatus(bool status); 
     void updateAnalysis(const FrequencyAnalysis& analysis);  // Modified to accept FrequencyAnalysis
-    void addAlert(FrequencyAlert alert);  // Added overload for FrequencyAlert
+    void addEvent(const AlarmEvent& event);
     void handleUpButton();
     void handleDownButton();
     void handleMuteButton();
     void loop();
+    uint16_t getAlarmCount() { return numAlarms; }
+    const AlarmRecord& getAlarm(uint16_t n) { return alarmHistory[(writeIndex + MAX_ALARMS - n) % MAX_ALARMS]; }  // Newest first
 
 private:
     LiquidCrystal_I2C lcd;
+
+    // Screens render into frame; flush() sends only the cells that differ
+    // from shadow (what the LCD shows) and glyphs that differ from the
+    // CGRAM cache. A steady screen costs no I2C traffic at all.
+    uint8_t frame[LCD_ROWS][LCD_COLS];
+    uint8_t shadow[LCD_ROWS][LCD_COLS];
+    uint8_t glyphs[LCD_GLYPHS][8];
+    uint8_t glyphsSet;                // Bit per slot: cache holds a definition
+    uint8_t glyphsDirty;              // Bit per slot: not yet uploaded
     bool hasAnalysis;
     FrequencyAnalysis currentAnalysis;
     bool currentWifiStatus;
@@ -88,13 +110,18 @@ private:
     unsigned long lastAlarmAdded;
     unsigned long lastButtonPress;
     uint32_t currentBuzzerFreq;
-    FrequencyAlert alarmHistory[MAX_ALARMS];
+    AlarmRecord alarmHistory[MAX_ALARMS];
     uint16_t writeIndex;
     bool writeOverflow;
     uint16_t numAlarms;
     uint16_t scrollPosition;
     void drawFrequencyBar(uint8_t row, float value);
+    void clearFrame();
+    void print(uint8_t col, uint8_t row, const char* text);
+    void defineGlyph(uint8_t slot, const uint8_t* rows);
+    void flush();
     void setBuzzer(uint32_t freq);
+    AlarmRecord* findRecord(const AlarmEvent& event);
 };
 
 #endif // DISPLAY_HANDLER_H
\ No newline at end of file
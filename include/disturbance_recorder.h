@@ -0,0 +1,70 @@
+#ifndef DISTURBANCE_RECORDER_H
+#define DISTURBANCE_RECORDER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <sys/time.h>
+#include "config.h"
+#include "adc_source.h"
+#include "alarm_engine.h"
+
+#define RECORDER_PRE_SLICES ((uint32_t)RECORDER_PRE_MS * SAMPLING_FREQUENCY / 1000 / PHASE_BLOCK_SIZE)
+#define RECORDER_POST_SLICES ((uint32_t)RECORDER_POST_MS * SAMPLING_FREQUENCY / 1000 / PHASE_BLOCK_SIZE)
+#define RECORDER_SLICES (RECORDER_PRE_SLICES + RECORDER_POST_SLICES)
+#define RECORDER_SLICE_BYTES (PHASE_BLOCK_SIZE * 3 / 2)   // Two 12-bit samples in three bytes
+#define RECORDER_DAT_RECORD 12                            // COMTRADE binary: sample, timestamp, 2 x int16
+
+static_assert(RECORDER_PRE_SLICES > 0 && RECORDER_POST_SLICES > 0, "Recorder windows shorter than a slice");
+static_assert(PHASE_BLOCK_SIZE % 2 == 0, "12-bit packing takes sample pairs");
+
+// One capture: a ring of slices (raw 12-bit samples plus the slice's
+// frequency). One slot more than a capture holds, so a block can be packed
+// before the analyzer knows whether its slice is intact.
+struct DisturbanceCapture {
+    uint8_t samples[RECORDER_SLICES + 1][RECORDER_SLICE_BYTES];
+    float frequency[RECORDER_SLICES + 1];   // NAN without a valid signal
+    uint16_t head;              // Slot of the next slice
+    uint16_t slices;            // Committed slices, up to RECORDER_SLICES
+    uint16_t postRemaining;     // Slices still to record after the trigger
+    bool triggered;
+    uint32_t lastIndex;         // Sample index of the newest slice (gap detection)
+    AlarmType type;
+    timeval trigger;            // Newest slice until triggered, then the trigger slice
+    uint32_t triggerSample;     // 0-based sample of the trigger within the capture
+};
+
+// Freezes raw samples around an alarm start. The analysis task packs the
+// newest block of each slice into the live buffer; a completed capture is
+// handed off by swapping buffers, so the sampler is never involved and the
+// next capture can start while the network side still exports the last.
+// A capture completing while the previous one is unexported, or cut by a
+// slice gap, is dropped.
+class DisturbanceRecorder {
+public:
+    DisturbanceRecorder();
+
+    // Analysis task
+    void stageBlock(const uint16_t* block);     // Newest block of the slice being analysed
+    void commitSlice(uint32_t sampleIndex, float frequency, const timeval& time);
+    void trigger(const AlarmEvent& event);
+    uint32_t getDropped() { return dropped; }
+
+    // Network side, valid while hasCapture()
+    bool hasCapture() { return frozenState.load(std::memory_order_acquire); }
+    const DisturbanceCapture& capture() { return buffers[frozen]; }
+    uint32_t records() { return (uint32_t)buffers[frozen].slices * PHASE_BLOCK_SIZE; }
+    size_t formatCfg(char* out, size_t size);
+    size_t formatDat(uint8_t* out, uint32_t firstRecord, uint32_t count);  // Binary .dat records
+    void release() { frozenState.store(false, std::memory_order_release); }
+
+private:
+    DisturbanceCapture buffers[2];
+    uint8_t live{0};
+    uint8_t frozen{1};
+    std::atomic<bool> frozenState{false};
+    uint32_t dropped{0};
+    void reset(DisturbanceCapture& c);
+    uint16_t sampleAt(const DisturbanceCapture& c, uint32_t n);
+};
+
+#endif // DISTURBANCE_RECORDER_H
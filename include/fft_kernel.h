@@ -0,0 +1,52 @@
+#ifndef FFT_KERNEL_H
+#define FFT_KERNEL_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "compact_layout.h"
+
+// FFT kernels (select with FFT_KERNEL in config.h)
+#define FFT_KERNEL_ARDUINO 0   // arduinoFFT, double precision (software-emulated on the ESP32)
+#define FFT_KERNEL_FLOAT   1   // In-tree real-input FFT, float32 (hardware FPU)
+#define FFT_KERNEL_Q15     2   // In-tree real-input FFT, Q15 fixed point with per-stage scaling
+
+#define REAL_FFT_HALF (ANALYSIS_SIZE / 2)
+
+// Real-input FFT of one analysis window: the ANALYSIS_SIZE real samples are
+// packed into ANALYSIS_SIZE/2 complex values (even = re, odd = im), run
+// through a half-size radix-2 FFT and split into the real spectrum again.
+// Only the bins that are actually needed are split and converted to
+// magnitudes. Window, twiddle and bit-reversal tables are shared and built
+// once. Output is scaled like arduinoFFT (Hamming, DC removed, unnormalised)
+// so thresholds and interpolation work unchanged.
+class RealFft {
+public:
+    RealFft();
+    void magnitude(const uint16_t* adcData, spectrum_t* vReal, uint16_t firstBin, uint16_t lastBin);
+    void magnitudeRange(spectrum_t* vReal, uint16_t firstBin, uint16_t lastBin);  // More bins of the last transform
+#if FFT_KERNEL_SELFTEST
+    static float selfTest();  // Max magnitude error vs. arduinoFFT, relative to the peak
+#endif
+
+private:
+#if FFT_KERNEL == FFT_KERNEL_Q15
+    int16_t re[REAL_FFT_HALF];
+    int16_t im[REAL_FFT_HALF];
+    static int16_t window[ANALYSIS_SIZE / 2];   // Q15, symmetric (first half only)
+    static int16_t twiddleRe[REAL_FFT_HALF];    // Q15, W_N^k = cos - j*sin
+    static int16_t twiddleIm[REAL_FFT_HALF];
+#else
+    float re[REAL_FFT_HALF];
+    float im[REAL_FFT_HALF];
+    static float window[ANALYSIS_SIZE / 2];
+    static float twiddleRe[REAL_FFT_HALF];
+    static float twiddleIm[REAL_FFT_HALF];
+#endif
+    static uint16_t bitReverse[REAL_FFT_HALF];
+    static bool tablesBuilt;
+    static void buildTables();
+    void load(const uint16_t* adcData);
+    void transform();
+};
+
+#endif // FFT_KERNEL_H
@@ -3,51 +3,159 @@
 
 #include <Arduino.h>
 #include <arduinoFFT.h>
+#include <atomic>
 #include "config.h"
+#include "sliding_dft.h"
+#include "fft_kernel.h"
+#include "zoom_dft.h"
+#include "adc_source.h"
+#include "compact_layout.h"
+#include "sample_clock.h"
+#include "frequency_tracker.h"
+#include "sogi_fll.h"
+#include "disturbance_recorder.h"
 
+// Spectrum engines (select with SPECTRUM_ENGINE in config.h)
+#define SPECTRUM_ENGINE_FFT  0   // Full arduinoFFT over the analysis window, once per slice
+#define SPECTRUM_ENGINE_SDFT 1   // Sliding DFT of the search bins, updated on every sample
+#define SPECTRUM_ENGINE_ZOOM 2   // Zoom DFT: mix-down, decimation and a dense grid over the search band only
 
+#define SAMPLER_STACK_SIZE 4096
+
+
+// Slice header, written by the sampler at every block boundary. The samples
+// are not copied: adcData points into the analyzer's ring. Time is derived
+// from sampleIndex by the SampleClock on the consumer side.
 struct AdcDataSlice {
-    uint16_t adcData[ANALYSIS_SIZE];
-    unsigned long millis;   // Time of Measurement
-    struct timeval time;    // Time of measurement with microsecond precision
+    const uint16_t* adcData;  // ANALYSIS_SIZE contiguous samples, ending with the newest
+    uint32_t sampleIndex;   // Absolute sample count at the end of the slice
+#if SPECTRUM_ENGINE == SPECTRUM_ENGINE_SDFT
+    SlidingDftSnapshot spectrum;  // Sliding DFT state at the end of the slice
+#endif
+#if SOGI_FLL
+    SogiFllOutput fll;      // SOGI-FLL at the end of the slice, mean over the slice
+#endif
 };
 
+// Ordered by size (no padding holes); result_t is float in the compact layout
 struct FrequencyAnalysis {
-    double frequency;        // Detected frequency in Hz
-    double amplitude;       // Signal amplitude
-    double quality;          // Quality metric of the measurement
-    double rawFrequency;     // Raw frequency before correction
-    bool isValidSignal;     // Indicates if the signal amplitude is above threshold
-    unsigned long millis;   // Time of Measurement
-    struct timeval time;    // Time of measurement with microsecond precision
+    struct timeval time;     // Time of measurement (UTC from the sample index, microsecond resolution)
+    result_t frequency;      // Detected frequency in Hz (fine if valid, else coarse)
+    result_t amplitude;      // Signal amplitude
+    result_t quality;        // Quality metric of the measurement
+    result_t rawFrequency;   // Raw frequency before correction
+    result_t fineFrequency;  // Phase-difference estimate over the newest block
+    result_t coarseFrequency;  // FFT estimate over the full analysis window
+    result_t rocof;          // Tracker RoCoF in Hz/s (FREQ_FILTER 2, else 0)
+    result_t fllFrequency;   // SOGI-FLL mean over the newest block (SOGI_FLL, else 0)
+    float harmonics[HARMONIC_MAX - 1];  // Harmonics 2..HARMONIC_MAX in % of the fundamental (NAN above Nyquist)
+    float thd;               // Total harmonic distortion in % (harmonics 2..HARMONIC_MAX)
+    float frequencySigma;    // Tracker standard deviations (FREQ_FILTER 2, else 0)
+    float rocofSigma;
+    float fllPhase;          // SOGI-FLL angle of the fundamental at the end of the slice (rad)
+    float clockPpm;          // Sample clock error applied to the frequencies (0 until SNTP drift is known)
+    unsigned long millis;    // Time of measurement on the sample clock (nominal ms since start)
+    bool isValidSignal;      // Indicates if the signal amplitude is above threshold
+    bool fineValid;          // Indicates if fineFrequency could be measured
+    bool harmonicsValid;     // Only with the full FFT spectrum (SPECTRUM_ENGINE 0)
+    bool outlier;            // Slice rejected by the tracker; frequency is the prediction
+    bool fllLocked;
+};
+
+// Newest block of an intact slice, for live streaming of the raw signal
+struct RawFrame {
+    uint32_t sampleIndex;       // Index of the newest sample
+    uint16_t samples[PHASE_BLOCK_SIZE];
 };
 
 class FrequencyAnalyzer {
 public:
     FrequencyAnalyzer();
-    void beginSampling();               // Creates the sampler task (call before enabling the timer)
-    IRAM_ATTR void notifySampleFromISR();
+    void beginSampling();               // Creates the sampler task, which starts the acquisition
+    void setSliceListener(TaskHandle_t task) { sliceListener = task; }  // Notified for every new slice
+#if DISTURBANCE_RECORDER
+    void setRecorder(DisturbanceRecorder* r) { recorder = r; }  // Gets the newest block of every intact slice
+#endif
+#if LIVE_SERVER && LIVE_RAW_FRAMES
+    void setRawQueue(QueueHandle_t queue) { rawQueue = queue; }  // RawFrame of every intact slice, never blocks
+    uint32_t getRawDrops() { return rawDrops; }                   // Frames the full queue did not take
+#endif
     bool getNextSliceAnalysis(FrequencyAnalysis*);
+    bool getAcquisitionLoad(AcquisitionLoad* load);  // False if the backend has no per-frame processing
+    uint32_t getDroppedSlices() { return droppedSlices; }
+    uint32_t getOverrunSlices() { return overrunSlices; }  // Part of the dropped slices skipped by overruns
 
 private:
 
-    // Sampling runs in a dedicated high-priority task, triggered by the
-    // hardware timer ISR via task notification. analogRead()/gettimeofday()
-    // are not ISR-safe, so they must not be called from interrupt context.
+    // Sampling runs in a dedicated high-priority task that blocks on the
+    // acquisition backend (timer ISR notification or DMA frame) and feeds
+    // every sample through processSample().
     static void samplerTaskEntry(void* arg);
-    void processSample();
+    void processSample(uint16_t sample);
     TaskHandle_t samplerTaskHandle{nullptr};
-    QueueHandle_t adcDataSliceQueue;
-    uint16_t ringBuffer[RING_BUFFER_SIZE]{0};
-    uint32_t writeIndex{0};
-    unsigned long lastSliceCopy{0};
-    AdcDataSlice sliceScratch;  // member, not stack local: ~1KB
+    TaskHandle_t sliceListener{nullptr};
+#if DISTURBANCE_RECORDER
+    DisturbanceRecorder* recorder{nullptr};
+#endif
+#if LIVE_SERVER && LIVE_RAW_FRAMES
+    QueueHandle_t rawQueue{nullptr};
+    RawFrame rawFrame;
+    uint32_t rawDrops{0};
+#endif
+    AdcSource* adcSource{nullptr};
+    SampleClock sampleClock;
+#if SOGI_FLL
+    SogiFll sogiFll;
+#endif
+
+    // Single-producer/single-consumer handoff. The sampler owns sampleCount
+    // and publishes it after each sample; the consumer only reads. Indices
+    // are absolute sample counts, masked into the ring. The first
+    // ANALYSIS_SIZE entries are mirrored behind the end, so a window never
+    // wraps and is analysed in place.
+    uint16_t ringBuffer[kRingSize + ANALYSIS_SIZE]{0};
+    uint32_t sampleCount{0};    // Slices are cut by sample count, not millis()
+    std::atomic<uint32_t> publishedCount{0};
+    AdcDataSlice sliceSlots[SLICE_SLOTS];
+    uint32_t nextSliceEnd{PHASE_BLOCK_SIZE};  // Consumer: sample index of the next slice
+    uint32_t droppedSlices{0};
+    uint32_t overrunSlices{0};
+    const AdcDataSlice* acquireSlice();
+    bool sliceIntact(const AdcDataSlice& slice);
 
     // Analyzing Management
-    double frequencyAvg{50};
-    double interpolateFrequency(double* vReal, uint16_t maxIndex, double maxAmplitude);
+    double frequencyAvg{TARGET_FREQUENCY};
+    FrequencyTracker tracker;
+    uint32_t lastTrackedIndex{0};
+#if SPECTRUM_ENGINE == SPECTRUM_ENGINE_SDFT
+    SlidingDft slidingDft;
+#elif SPECTRUM_ENGINE == SPECTRUM_ENGINE_ZOOM
+    ZoomDft zoomDft;
+#elif FFT_KERNEL != FFT_KERNEL_ARDUINO
+    RealFft realFft;
+#endif
+    uint16_t findPeak(const spectrum_t* vReal, uint16_t startBin, uint16_t endBin, double* maxAmplitude);
+    double interpolatePeak(const spectrum_t* vReal, uint16_t maxIndex);
     double calculateBinError(double p);
 
+    // Power quality from the same spectrum: band energy around h * f
+    double harmonicEnergyScale{1};       // sqrt(band energy) -> peak-bin amplitude (Hamming)
+    double harmonicGain[HARMONIC_MAX + 1];  // Acquisition filter response at h * TARGET_FREQUENCY
+#if HARMONIC_ANALYSIS && SPECTRUM_ENGINE == SPECTRUM_ENGINE_FFT
+    void analyzeHarmonics(spectrum_t* vReal, double fundamental, FrequencyAnalysis* frequencyAnalysis);
+#endif
+
+    // Phase-difference fine estimator (see KONZEPT_4HZ_MESSUNG.txt)
+    // Hann-windowed single-bin correlation per block, frequency from the
+    // phase rotation between two consecutive blocks.
+    float phaseRefRe[PHASE_BLOCK_SIZE];
+    float phaseRefIm[PHASE_BLOCK_SIZE];
+    double lastPhase{0};
+    uint32_t lastPhaseIndex{0};
+    bool hasLastPhase{false};
+    bool measurePhase(const uint16_t* block, double* phase);
+    bool estimateFineFrequency(const AdcDataSlice& slice, double coarseFrequency, double* fineFrequency);
+
 };
 
 #endif // FREQUENCY_ANALYZER_H
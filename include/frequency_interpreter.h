@@ -2,30 +2,35 @@
 #define FREQUENCY_INTERPRETER_H
 
 #include "frequency_analyzer.h"
+#include "rocof_engine.h"
+#include "alarm_engine.h"
 #include "config.h"
 
 // Interpreter Constants
 struct FrequencyAlert {
     bool valid;
-    bool hasAlert;
-    const char* alertType;
+    bool hasAlert;                // Any alarm event active
+    AlarmType alertType;          // Most severe active event
     FrequencyAnalysis frequencyAnalysis;
     float deviation;
-    float ramp;
-    char message[LCD_COLS];
+    float ramp;                   // Signed RoCoF in Hz/s (tracker or difference quotient)
+    float rocof[ROCOF_WINDOWS];   // Least-squares RoCoF per window, NAN until filled
     unsigned long analyzingDelay;
 };
 
 class FrequencyInterpreter {
     public:
         FrequencyInterpreter();
-        FrequencyAlert interpret(const FrequencyAnalysis& analysis);
+        FrequencyAlert interpret(const FrequencyAnalysis& analysis, AlarmEvent* events, uint8_t* eventCount);
 
     private:
+        void updateMetrics(const FrequencyAnalysis& analysis, FrequencyAlert* alert);
         unsigned long lastRun{0};
         float lastFreq{0};
         float lastRamp{0};
         uint8_t warmup{40};
+        RocofEngine rocofEngine;
+        AlarmEngine alarmEngine;
 };
 
 #endif // FREQUENCY_INTERPRETER_H
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef FREQUENCY_TRACKER_H
+#define FREQUENCY_TRACKER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Output filters (select with FREQ_FILTER in config.h)
+#define FREQ_FILTER_NONE   0   // Per-slice estimate as measured
+#define FREQ_FILTER_EMA    1   // Legacy fixed EMA (0.75/0.25), ~1 s lag, no outlier handling
+#define FREQ_FILTER_KALMAN 2   // FrequencyTracker below
+
+#define HAMPEL_WINDOW 5
+
+struct TrackerOutput {
+    double frequency;       // Filtered frequency in Hz
+    double rocof;           // Rate of change of frequency in Hz/s (signed)
+    float frequencySigma;   // Standard deviations from the state covariance
+    float rocofSigma;
+    bool outlier;           // Measurement was rejected, output is the prediction
+};
+
+// Constant-RoCoF Kalman filter over the per-slice frequency estimates.
+// State [f, df/dt], process noise is white change of RoCoF
+// (KALMAN_ROCOF_NOISE). The measurement variance comes from the slice:
+// it grows when the amplitude or the spectral peak quality gets worse, and
+// is larger for coarse-only estimates.
+//
+// Outliers: a measurement outside the innovation gate is dropped only if a
+// Hampel test on the recent raw measurements agrees. A genuine step moves
+// the Hampel median within a few slices and then re-initialises the filter,
+// so steps are followed without the EMA's lag and single bad slices never
+// reach the RoCoF.
+class FrequencyTracker {
+public:
+    void update(double measurement, double amplitude, double quality, bool fine, double dt, TrackerOutput* out);
+    void reset() { initialised = false; hampelCount = 0; }
+
+private:
+    bool initialised{false};
+    double f{0};
+    double r{0};
+    double p00{0}, p01{0}, p11{0};
+    double hampel[HAMPEL_WINDOW]{0};
+    uint8_t hampelCount{0};
+    uint8_t hampelNext{0};
+
+    double measurementVariance(double amplitude, double quality, bool fine);
+    bool hampelOutlier(double measurement, double sigma);
+    void initialise(double measurement, double variance);
+};
+
+#endif // FREQUENCY_TRACKER_H
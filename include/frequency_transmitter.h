@@ -1,20 +1,67 @@
 #ifndef FREQUENCY_TRANSMITTER_H
 #define FREQUENCY_TRANSMITTER_H
 
-#include <WiFi.h>
-#include <PubSubClient.h>
 #include "config.h"
+#include "networking.h"
 #include "frequency_analyzer.h"
 #include "frequency_interpreter.h"
+#include "memory_budget.h"
+#include "stream_stats.h"
+#include "disturbance_recorder.h"
+#include "payload_codec.h"
+#include "measurement_journal.h"
+#include "report_filter.h"
+#include "live_server.h"
 
 class FrequencyTransmitter {
 public:
-    FrequencyTransmitter(PubSubClient& client);
+    FrequencyTransmitter(Networking& network);
+    void begin();                 // Mounts the journal (MEASUREMENT_JOURNAL)
     void transmit(const FrequencyAlert& alert);
+    void transmitEvent(const AlarmEvent& event);   // Alarm start/update/end, to MQTT_TOPIC "/events"
+    void transmitStats(const StatsSummary& summary);  // Closed interval, to MQTT_TOPIC "/stats"
+    bool transmitMemoryBudget();  // Once per boot, to MQTT_TOPIC "/memory"
+    void transmitNetworkStats();  // Outbound queue counters, to MQTT_TOPIC "/net"
+#if LIVE_SERVER
+    void setLiveServer(LiveServer* server) { liveServer = server; }  // Gets every result as JSON
+#endif
+#if DISTURBANCE_RECORDER
+    void transmitCapture(DisturbanceRecorder& recorder);  // Next piece of the frozen capture; releases it when done
+#endif
+#if MEASUREMENT_JOURNAL
+    void transmitBackfill();      // Next journal chunk to MQTT_TOPIC "/backfill" (throttled) and its status
+#endif
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BATCH
+    void flushIfDue();            // Sends a batch older than BATCH_MAX_LATENCY_MS
+#endif
 
 private:
-    PubSubClient& mqttClient;
+    Networking& network;          // Publishing only enqueues
+    void publishMeasurement(const FrequencyAlert& alert);
+#if REPORT_MODE == REPORT_MODE_CHANGE
+    ReportFilter reportFilter;
+#endif
+    bool transmitJson(const FrequencyAlert& alert, const SystemMetrics& metrics);
+    static size_t formatJson(const FrequencyAlert& alert, const SystemMetrics& metrics, char* message, size_t size);
+#if LIVE_SERVER
+    LiveServer* liveServer{nullptr};
+#endif
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BATCH
+    BatchEncoder batch;
+    SystemMetrics batchMetrics;   // Newest metrics, sent once per batch
+    void flushBatch();
+#endif
     const char* mqttTopic;
+#if DISTURBANCE_RECORDER
+    bool captureCfgSent{false};
+    uint32_t captureRecord{0};     // Next .dat record to publish
+#endif
+#if MEASUREMENT_JOURNAL
+    MeasurementJournal journal;
+    void journalMeasurement(const FrequencyAlert& alert, const SystemMetrics& metrics);
+    unsigned long lastBackfill{0};
+    unsigned long lastJournalStatus{0};
+#endif
 };
 
 #endif // FREQUENCY_TRANSMITTER_H
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef GRID_PROFILE_H
+#define GRID_PROFILE_H
+
+#include <stdint.h>
+
+// Grid profiles (select with GRID_PROFILE in config.h). Each profile fixes
+// the nominal frequency, the window geometry and the search band; all
+// analysis buffers, bin ranges and estimator constants follow from these
+// at compile time, so a 60 Hz or railway build is the same source with a
+// different profile number.
+#define GRID_PROFILE_50HZ      0   // Continental Europe, 50 Hz
+#define GRID_PROFILE_60HZ      1   // North America, 60 Hz
+#define GRID_PROFILE_RAILWAY   2   // 16.7 Hz traction grid (DE/AT/CH/SE/NO)
+
+#if GRID_PROFILE == GRID_PROFILE_50HZ
+#define TARGET_FREQUENCY 50.000f   // Nominal frequency (Hz)
+#define SAMPLING_FREQUENCY 512     // ADC sampling rate (Hz)
+#define ANALYSIS_SIZE 512          // FFT window (1 s, 1 Hz bins)
+#define PHASE_BLOCK_SIZE 128       // Samples per measurement block (250 ms => 4 Hz)
+#define SEARCH_MIN_FREQUENCY 45    // Spectral peak search band (Hz)
+#define SEARCH_MAX_FREQUENCY 55
+#elif GRID_PROFILE == GRID_PROFILE_60HZ
+#define TARGET_FREQUENCY 60.000f
+#define SAMPLING_FREQUENCY 512     // Harmonics above the 4th fall beyond Nyquist and are reported as null
+#define ANALYSIS_SIZE 512
+#define PHASE_BLOCK_SIZE 128
+#define SEARCH_MIN_FREQUENCY 55
+#define SEARCH_MAX_FREQUENCY 65
+#elif GRID_PROFILE == GRID_PROFILE_RAILWAY
+#define TARGET_FREQUENCY 16.700f
+#define SAMPLING_FREQUENCY 512
+#define ANALYSIS_SIZE 1024         // 2 s window: 0.5 Hz bins for the narrow band
+#define PHASE_BLOCK_SIZE 128       // 250 ms = 4.2 cycles per block
+#define SEARCH_MIN_FREQUENCY 15
+#define SEARCH_MAX_FREQUENCY 18
+#else
+#error "Unknown GRID_PROFILE"
+#endif
+
+// Derived constants
+constexpr double kBinWidth = (double)SAMPLING_FREQUENCY / ANALYSIS_SIZE;          // Hz per FFT bin
+constexpr uint16_t kSearchFirstBin = SEARCH_MIN_FREQUENCY * ANALYSIS_SIZE / SAMPLING_FREQUENCY;
+constexpr uint16_t kSearchLastBin = SEARCH_MAX_FREQUENCY * ANALYSIS_SIZE / SAMPLING_FREQUENCY;
+constexpr double kBinErrorScale = 0.06 * kBinWidth;                              // Gaussian interpolation bias fit, in Hz
+constexpr double kBlockCycles = (double)TARGET_FREQUENCY * PHASE_BLOCK_SIZE / SAMPLING_FREQUENCY;
+constexpr double kPhaseStepNominal = 6.283185307179586 * (kBlockCycles - (int32_t)kBlockCycles);  // Rotation per block, 0..2pi
+constexpr double kPhaseAmbiguity = (double)SAMPLING_FREQUENCY / (2.0 * PHASE_BLOCK_SIZE);       // Fine estimate is unique within +/- this (Hz)
+
+constexpr bool isPowerOfTwo(uint32_t x) { return x != 0 && (x & (x - 1)) == 0; }
+
+static_assert(isPowerOfTwo(ANALYSIS_SIZE), "ANALYSIS_SIZE must be a power of two (FFT, masked twiddles)");
+static_assert(isPowerOfTwo(RING_BUFFER_SIZE), "RING_BUFFER_SIZE must be a power of two (masked indexes)");
+static_assert(ANALYSIS_SIZE % PHASE_BLOCK_SIZE == 0, "The analysis window must hold whole blocks");
+static_assert(SEARCH_MIN_FREQUENCY < TARGET_FREQUENCY && TARGET_FREQUENCY < SEARCH_MAX_FREQUENCY, "Search band must contain the nominal frequency");
+static_assert(2 * SEARCH_MAX_FREQUENCY < SAMPLING_FREQUENCY, "Search band above Nyquist");
+static_assert(kSearchFirstBin >= 2 && kSearchLastBin + 2 < ANALYSIS_SIZE / 2, "Search bins need two neighbours below Nyquist");
+static_assert(kSearchLastBin - kSearchFirstBin >= 2, "Search band narrower than the bin grid");
+static_assert(PHASE_MAX_DEVIATION < kPhaseAmbiguity, "Phase-difference estimate would be ambiguous around the coarse estimate");
+
+#endif // GRID_PROFILE_H
@@ -0,0 +1,74 @@
+#ifndef LIVE_SERVER_H
+#define LIVE_SERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+#define LIVE_RX_BUFFER 512            // Request headers / client frames
+#define LIVE_STATUS_BUFFER 1536       // /status body
+#define LIVE_RAW_QUEUE_LENGTH 4       // Raw frames between analysis task and loop() (1 s)
+
+// Fills the /status body (JSON), returns its length or 0 on overflow
+typedef size_t (*LiveStatusFormatter)(char* out, size_t size);
+
+enum LiveClientState : uint8_t {
+    LIVE_CLIENT_FREE,
+    LIVE_CLIENT_HTTP,                 // Reading the request
+    LIVE_CLIENT_WEBSOCKET,
+    LIVE_CLIENT_CLOSING               // Close once the send buffer is drained
+};
+
+struct LiveClient {
+    int fd;
+    LiveClientState state;
+    bool raw;                         // Subscribed to ADC frames
+    uint16_t rxLength;
+    uint16_t txLength;
+    uint32_t drops;                   // Frames that did not fit the send buffer
+    unsigned long lastProgress;       // Buffer empty or data sent
+    uint8_t rx[LIVE_RX_BUFFER];
+    uint8_t tx[LIVE_CLIENT_BUFFER];
+};
+
+// Minimal HTTP/1.1 + WebSocket (RFC 6455) server on plain POSIX sockets
+// (lwIP on the ESP32), so it also builds and runs on a host:
+//   GET /          small live page
+//   GET /status    JSON from the status formatter
+//   GET /ws        text frame per measurement; /ws?raw=1 adds binary ADC frames
+// All sockets are non-blocking and every buffer is static: poll() and
+// broadcast() never wait and never allocate. Each client has its own send
+// buffer; a frame that does not fit is dropped for that client only, and a
+// client whose buffer does not drain for LIVE_STALL_MS is disconnected.
+class LiveServer {
+public:
+    LiveServer(LiveStatusFormatter statusFormatter);
+    bool begin(uint16_t port);
+    void poll(unsigned long nowMs);   // Accept, read, answer, send; bounded work
+    void broadcast(const char* text, size_t length);            // To every WebSocket client
+    void broadcastRaw(const uint8_t* data, size_t length);      // To /ws?raw=1 clients
+    bool hasClients() { return webSockets > 0; }
+    bool hasRawClients() { return rawClients > 0; }
+    uint32_t getDrops() { return drops; }
+
+private:
+    int listenFd{-1};
+    LiveStatusFormatter statusFormatter;
+    LiveClient clients[LIVE_MAX_CLIENTS];
+    uint8_t webSockets{0};
+    uint8_t rawClients{0};
+    uint32_t drops{0};
+    char status[LIVE_STATUS_BUFFER];
+    void accept(unsigned long nowMs);
+    void receive(LiveClient& c);
+    void send(LiveClient& c, unsigned long nowMs);
+    void close(LiveClient& c);
+    void handleRequest(LiveClient& c);
+    void handleFrames(LiveClient& c);
+    bool queue(LiveClient& c, const void* data, size_t length);
+    bool queueFrame(LiveClient& c, uint8_t opcode, const void* payload, size_t length);
+    void respond(LiveClient& c, const char* status, const char* type, const char* body, size_t length);
+    void countClients();
+};
+
+#endif // LIVE_SERVER_H
@@ -8,9 +8,12 @@
 #include "frequency_interpreter.h"
 #include "frequency_transmitter.h"
 #include "display_handler.h"
+#include "memory_budget.h"
+#include "stream_stats.h"
+#include "disturbance_recorder.h"
+#include "live_server.h"
 
 // Global variables
-extern hw_timer_t* timer;
 extern Networking* networking;
 extern FrequencyAnalyzer* analyzer;
 extern FrequencyInterpreter* interpreter;
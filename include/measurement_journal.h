@@ -0,0 +1,60 @@
+#ifndef MEASUREMENT_JOURNAL_H
+#define MEASUREMENT_JOURNAL_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "payload_codec.h"
+
+#define JOURNAL_DIR "/journal"
+#define JOURNAL_PAGE_HEADER 16
+#define JOURNAL_PAGE_RECORDS ((JOURNAL_PAGE_SIZE - JOURNAL_PAGE_HEADER) / PAYLOAD_BINARY_SIZE)
+#define JOURNAL_CAPACITY ((uint32_t)JOURNAL_PAGES * JOURNAL_PAGE_RECORDS)
+
+static_assert(JOURNAL_PAGE_RECORDS > 0, "Journal page smaller than a record");
+static_assert(JOURNAL_PAGES >= 2, "Journal ring needs at least two pages");
+
+// Page file: u32 magic, u32 sequence, u16 records, u16 record size, u32
+// reserved, then version 1 measurement records (payload_codec.h), oldest first.
+struct JournalPageHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint16_t records;
+    uint16_t recordSize;
+    uint32_t reserved;
+};
+static_assert(sizeof(JournalPageHeader) == JOURNAL_PAGE_HEADER, "Journal page header layout");
+
+// Append-only ring of measurement records on LittleFS, for measurements taken
+// while MQTT is down. Records collect in a RAM page and go to flash one full
+// page at a time, each page into its own slot file (sequence % JOURNAL_PAGES);
+// LittleFS writes a rewritten slot to fresh blocks, which spreads the wear
+// over the partition. A full ring overwrites its oldest page.
+// The read position is saved when a page has been sent, so a reboot resends
+// at most one page, and loses the records still in RAM.
+// Not thread-safe: append and drain from the same task.
+class MeasurementJournal {
+public:
+    bool begin();                               // Mounts LittleFS and recovers the ring
+    void append(const uint8_t* record);         // One PAYLOAD_BINARY_SIZE record
+    uint16_t peek(uint8_t* out, uint16_t maxRecords);  // Oldest unsent records, left in the journal
+    void consume(uint16_t records);             // Removes records returned by peek()
+    uint32_t depth();                           // Unsent records
+    int64_t oldestTime();                       // UNIX ms of the oldest unsent record, 0 when empty
+    uint32_t flashPages() { return writeSeq - readSeq; }
+    uint32_t getLost() { return lost; }
+
+private:
+    uint8_t page[JOURNAL_PAGE_SIZE];            // Page being collected
+    uint16_t pageRecords{0};
+    uint16_t pageRead{0};                       // Records of the RAM page already sent
+    uint32_t writeSeq{0};                       // Sequence of the RAM page
+    uint32_t readSeq{0};                        // Oldest unsent page on flash (== writeSeq: none)
+    uint16_t readRecord{0};                     // Next unsent record in it
+    uint32_t lost{0};                           // Records overwritten or not stored
+    bool mounted{false};
+    void writePage();
+    bool readSlot(uint32_t seq, JournalPageHeader* header);
+    void savePosition();
+};
+
+#endif // MEASUREMENT_JOURNAL_H
@@ -0,0 +1,22 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Static RAM per module of this build, from sizeof() at compile time.
+// Entries named "module.part" are contained in the entry before them and
+// are not added to the total.
+struct MemoryBudgetEntry {
+    const char* module;
+    uint32_t bytes;
+};
+
+extern const MemoryBudgetEntry memoryBudget[];
+extern const uint8_t memoryBudgetEntries;
+
+uint32_t memoryBudgetTotal();
+void printMemoryBudget();
+size_t formatMemoryBudget(char* out, size_t size);  // JSON object {"total":..,"modules":{..}}
+
+#endif // MEMORY_BUDGET_H
@@ -5,28 +5,71 @@
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <PubSubClient.h>
+#include <atomic>
 #include <time.h>
 #include "config.h"
 #include "display_handler.h"
+#include "outbound_queue.h"
 
 extern DisplayHandler* display;
 
+// Outbound queue counters
+struct NetworkStats {
+    uint32_t queued;            // Bytes in the queue now
+    uint32_t peak;              // Highest queue use since boot
+    uint32_t sent;
+    uint32_t failed;            // Rejected by the client while connected
+    uint32_t rejected[NET_PRIORITIES];  // Queue full for the message's class
+    uint32_t reconnects;
+};
+
+// WiFi, MQTT and TLS live in their own task on NET_TASK_CORE: it connects,
+// keeps the session alive and drains the outbound queue. Everything else
+// only enqueues (from loop(), the single producer), so a slow or dead
+// broker, or a TLS handshake blocking for 2 x NET_TIMEOUT_S, never stalls
+// acquisition, analysis or the LCD. A message is kept in the queue until
+// it was published, so one waiting out a reconnect is sent afterwards.
 class Networking {
     public:
         Networking();
-        void begin();
-        void loop();
-        bool isConnected() { return mqttClient.connected(); }
-        PubSubClient& getMqttClient() { return mqttClient; }
+        void begin();               // Starts the network task
+        void loop();                // Status to the display; never blocks
+        bool isConnected() { return mqttConnected.load(std::memory_order_acquire); }
+        bool isWifiConnected() { return wifiConnected.load(std::memory_order_acquire); }
+        int8_t getRssi() { return rssi.load(std::memory_order_relaxed); }  // dBm, 0 while WiFi is down
+        bool publish(const char* topic, const uint8_t* payload, size_t length, NetPriority priority);
+        bool publish(const char* topic, const char* message, NetPriority priority) {
+            return publish(topic, (const uint8_t*)message, strlen(message), priority);
+        }
+        NetworkStats getStats();
 
     private:
-        // Network clients
+        // Network clients, network task only
         WiFiClientSecure espClient;
         PubSubClient mqttClient;
+        TaskHandle_t taskHandle{nullptr};
+        OutboundQueue queue;
         unsigned long lastStatusCheck{0};
         unsigned long lastMqttAttempt{0};
         bool wifiWasDown{false};
         unsigned long wifiDownSince{0};
+
+        // Shared with the producer
+        std::atomic<bool> wifiConnected{false};
+        std::atomic<bool> mqttConnected{false};
+        std::atomic<int8_t> rssi{0};
+        std::atomic<uint32_t> sent{0};
+        std::atomic<uint32_t> failed{0};
+        std::atomic<uint32_t> reconnects{0};
+
+        // Producer only
+        uint32_t peak{0};
+        uint32_t rejected[NET_PRIORITIES]{};
+
+        static void taskEntry(void* arg);
+        void taskLoop();
+        void manageConnection();
+        void drainQueue();
         void setupWiFi();
         void setupMqtt();
         void forceWiFiReconnect();
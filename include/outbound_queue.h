@@ -0,0 +1,51 @@
+#ifndef OUTBOUND_QUEUE_H
+#define OUTBOUND_QUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+#define OUTBOUND_HEADER 8
+
+static_assert((NET_QUEUE_BYTES & (NET_QUEUE_BYTES - 1)) == 0, "NET_QUEUE_BYTES must be a power of two");
+static_assert(NET_QUEUE_BYTES <= 32768, "Entry sizes are 16 bit");
+
+// Message classes, in order of precedence. Each may only fill the queue up
+// to its own limit, so bulk transfers never crowd out live data and live
+// data never crowds out alarm events.
+enum NetPriority : uint8_t {
+    NET_PRIORITY_BULK,    // Backfill, capture export: the producer retries later
+    NET_PRIORITY_LIVE,    // Measurements, statistics, status: dropped when full
+    NET_PRIORITY_EVENT,   // Alarm events: may use the whole queue
+    NET_PRIORITIES
+};
+
+// View of the oldest queued message, valid until pop()
+struct OutboundMessage {
+    const char* topic;
+    const uint8_t* payload;
+    uint16_t length;
+};
+
+// Lock-free single-producer single-consumer ring of MQTT messages. Entries
+// are variable length and contiguous: one that would wrap is preceded by a
+// padding entry up to the end of the buffer. head and tail count bytes
+// since start and are only written by producer and consumer respectively.
+class OutboundQueue {
+public:
+    // Producer: false if the message would take the queue above limit bytes
+    bool push(const char* topic, const uint8_t* payload, uint16_t length, uint32_t limit);
+
+    // Consumer
+    bool front(OutboundMessage* message);
+    void pop();
+
+    uint32_t used() { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+private:
+    alignas(OUTBOUND_HEADER) uint8_t buffer[NET_QUEUE_BYTES];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+};
+
+#endif // OUTBOUND_QUEUE_H
@@ -0,0 +1,86 @@
+#ifndef PAYLOAD_CODEC_H
+#define PAYLOAD_CODEC_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "frequency_interpreter.h"
+
+// Measurement encodings (select with PAYLOAD_FORMAT in config.h)
+#define PAYLOAD_FORMAT_JSON   0   // JSON on MQTT_TOPIC
+#define PAYLOAD_FORMAT_BINARY 1   // Packed schema on MQTT_TOPIC "/bin", decoder in tools/decode_payload.py
+#define PAYLOAD_FORMAT_BATCH  2   // BATCH_SIZE delta-encoded measurements per message on MQTT_TOPIC "/batch"
+
+#define PAYLOAD_VERSION 1
+#define PAYLOAD_BATCH_VERSION 2
+#define PAYLOAD_BATCH_HEADER 26
+#define PAYLOAD_BATCH_SAMPLE_MAX 10   // Two zigzag varints of up to 5 bytes
+#define PAYLOAD_BATCH_INTERVAL_MS ((uint16_t)(1000UL * PHASE_BLOCK_SIZE * RAW_PUBLISH_DIVIDER / SAMPLING_FREQUENCY))
+#define PAYLOAD_MISSING_I32 ((int32_t)0x80000000)
+#define PAYLOAD_MISSING_U16 0xFFFF
+#define PAYLOAD_MISSING_I16 ((int16_t)0x8000)
+#define PAYLOAD_BINARY_SIZE (51 + 4 * ROCOF_WINDOWS + 2 * HARMONIC_MAX)
+#define PAYLOAD_RAW_HEADER 12
+#define PAYLOAD_RAW_SIZE (PAYLOAD_RAW_HEADER + 2 * PHASE_BLOCK_SIZE)
+
+// Flags byte
+#define PAYLOAD_FLAG_ALERT      0x01
+#define PAYLOAD_FLAG_VALID      0x02   // Signal amplitude above threshold
+#define PAYLOAD_FLAG_FINE       0x04
+#define PAYLOAD_FLAG_OUTLIER    0x08
+#define PAYLOAD_FLAG_FLL_LOCKED 0x10
+#define PAYLOAD_FLAG_HARMONICS  0x20
+
+// Board state sent with every measurement
+struct SystemMetrics {
+    uint32_t freeHeap;
+    float heapUsage;
+    uint16_t cpuFreq;
+    int8_t rssi;
+};
+
+// Version 1, little-endian, fixed-point fields (see tools/decode_payload.py):
+//   u8 version, u8 flags, u8 alertType, u8 counts (rocof windows << 4 | harmonics)
+//   i64 time ms, u16 nominal mHz, u32 freq/freqCoarse/freqFll uHz, u32 amp,
+//   u16 quality 1e-4, i32 ramp uHz/s, i32 rocof[] uHz/s, u16 rocofStd 0.1 mHz/s,
+//   u16 thd + harm[] 0.01 %, u16 analyzingDelay ms, i16 clockPpm 0.01,
+//   u32 freeHeap, u16 heapUsage 0.1 %, u16 cpuFreq, i8 rssi
+// NaN/inf (and values not measured) are sent as the PAYLOAD_MISSING_* code
+// of the field's type; u32 fields as 0.
+size_t encodeMeasurement(const FrequencyAlert& alert, const SystemMetrics& metrics, uint8_t* out, size_t size);
+
+// Version 2, consecutive measurements at a fixed interval in one message:
+//   u8 version, u8 flags (OR of the samples), u8 alertType (newest), u8 count,
+//   i64 base time ms, u16 interval ms, u16 nominal mHz,
+//   u32 freeHeap, u16 heapUsage 0.1 %, u16 cpuFreq, i8 rssi, u8 reserved
+// then per sample: zigzag varint delta of freq (0.1 mHz from nominal) and of
+// amp (counts), the first against 0. Sample i is at base + i * interval.
+// A non-finite freq or amp is sent as nominal or 0.
+class BatchEncoder {
+public:
+    BatchEncoder() { reset(); }
+    void reset();
+    bool add(const FrequencyAlert& alert);   // False if the measurement does not continue the batch
+    bool full() const { return samples >= BATCH_SIZE; }
+    uint8_t count() const { return samples; }
+    unsigned long firstMillis() const { return startedAt; }
+    size_t finish(const SystemMetrics& metrics, uint8_t* out, size_t size);
+
+private:
+    uint8_t body[BATCH_SIZE * PAYLOAD_BATCH_SAMPLE_MAX];
+    size_t bodyLength;
+    uint8_t samples;
+    uint8_t flags;
+    uint8_t alertType;
+    int64_t baseTime;
+    int64_t lastTime;
+    int32_t lastFrequency;
+    int32_t lastAmplitude;
+    unsigned long startedAt;      // millis() of the first sample, for the latency budget
+    void putVarint(int32_t delta);
+};
+
+// Raw ADC block for live clients: u32 index of the newest sample, u16 count,
+// u8 bits per sample, u8 reserved, u32 sampling rate Hz, then u16 samples
+size_t encodeRawFrame(const RawFrame& frame, uint8_t* out, size_t size);
+
+#endif // PAYLOAD_CODEC_H
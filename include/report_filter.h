@@ -0,0 +1,52 @@
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "frequency_interpreter.h"
+
+// Measurement reporting (select with REPORT_MODE in config.h)
+#define REPORT_MODE_ALL    0   // Every result
+#define REPORT_MODE_CHANGE 1   // Swinging-door compression with heartbeat, full rate during alarms
+
+// One swinging door: the range of slopes from the anchor that keeps every
+// point since within +-deviation of the line.
+struct SwingingDoor {
+    int64_t anchorMs;
+    double anchor;
+    double upper;               // Slope limits in units per ms
+    double lower;
+    void start(int64_t ms, double value);
+    bool admits(int64_t ms, double value, double deviation) const;
+    void add(int64_t ms, double value, double deviation);
+    double valueAt(int64_t ms, double value) const;  // Nearest to value on a line within the doors
+};
+
+// Change-driven reporting. Reported measurements are the vertices of a
+// piecewise-linear series that stays within REPORT_FREQ_DEADBAND Hz and
+// REPORT_AMP_DEADBAND counts of every result in between: when a result no
+// longer fits through the doors, the previous one is reported, its
+// frequency and amplitude moved onto the door line by at most the
+// deadband. Alarm state changes, results during an alarm and a signal
+// change go out unmodified at once; REPORT_HEARTBEAT_MS bounds the time
+// between reports. A quiet vertex is reported one result late.
+class ReportFilter {
+public:
+    uint8_t update(const FrequencyAlert& alert, FrequencyAlert* out);  // Up to 2 reports, oldest first
+
+private:
+    SwingingDoor frequency;
+    SwingingDoor amplitude;
+    FrequencyAlert held;        // Newest result, reported if the next one breaks the doors
+    bool hasHeld{false};
+    bool started{false};
+    bool lastAlert{false};
+    AlarmType lastType{ALARM_NONE};
+    bool lastValid{false};
+    bool admits(int64_t ms, const FrequencyAlert& alert) const;
+    void add(int64_t ms, const FrequencyAlert& alert);
+    FrequencyAlert vertex(int64_t ms, const FrequencyAlert& alert) const;
+    void restart(int64_t ms, const FrequencyAlert& report);
+};
+
+#endif // REPORT_FILTER_H
@@ -0,0 +1,44 @@
+#ifndef ROCOF_ENGINE_H
+#define ROCOF_ENGINE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define ROCOF_SLICE_MS (1000.0 * PHASE_BLOCK_SIZE / SAMPLING_FREQUENCY)  // Spacing of the measurements
+
+constexpr uint16_t kRocofWindowMs[ROCOF_WINDOWS] = ROCOF_WINDOW_MS;
+constexpr float kRocofThresholds[ROCOF_WINDOWS] = ROCOF_WINDOW_THRESHOLDS;
+
+constexpr uint16_t rocofMaxWindowMs(uint8_t i = 0) {
+    return i >= ROCOF_WINDOWS ? 0 : (kRocofWindowMs[i] > rocofMaxWindowMs(i + 1) ? kRocofWindowMs[i] : rocofMaxWindowMs(i + 1));
+}
+#define ROCOF_HISTORY ((uint16_t)(rocofMaxWindowMs() / ROCOF_SLICE_MS) + 1)  // Points of the longest window
+
+// Least-squares RoCoF over several window lengths at once. Measurements
+// (one per slice, equally spaced) are stored as integer uHz deviations in
+// one ring shared by all windows. Each window keeps sum(y) and sum(x*y)
+// with x = 0..N-1 from its oldest point; sliding by one point is
+//   sum(x*y) -= sum(y) - y_old;  sum(x*y) += (N-1) * y_new
+// so an update is O(1) per window, and exact (no drift) in 64-bit integers.
+// A gap in the measurements or a lost signal restarts all windows.
+class RocofEngine {
+public:
+    RocofEngine();
+    void update(double frequency, unsigned long millis);
+    void reset();
+    float getRocof(uint8_t window);   // Signed Hz/s, NAN until the window is filled
+    static uint16_t windowMs(uint8_t window) { return kRocofWindowMs[window]; }
+    static float threshold(uint8_t window) { return kRocofThresholds[window]; }
+
+private:
+    int32_t history[ROCOF_HISTORY];
+    uint16_t head{0};
+    uint16_t points[ROCOF_WINDOWS];
+    uint16_t filled[ROCOF_WINDOWS];
+    int64_t sumY[ROCOF_WINDOWS];
+    int64_t sumXY[ROCOF_WINDOWS];
+    unsigned long lastMillis{0};
+    bool started{false};
+};
+
+#endif // ROCOF_ENGINE_H
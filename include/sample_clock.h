@@ -0,0 +1,51 @@
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+#include <Arduino.h>
+#include <sys/time.h>
+#include "config.h"
+
+// Maps the absolute sample counter to UTC. The sample counter is the
+// timebase (it is what the frequency is measured against); every SNTP
+// update adds a point (sample index, UTC) and a least-squares line through
+// the last TIMEBASE_POINTS points gives the real sample period, i.e. the
+// crystal error in ppm, and the offset. Slices are timestamped from their
+// sample index only, so no clock is read on the sampler's hot path.
+//
+// Until the first SNTP update (or without WiFi) the counter runs free from
+// the system time at construction with the nominal period.
+class SampleClock {
+public:
+    SampleClock();
+    void begin();                                 // Registers for SNTP updates
+    void markRead(uint32_t sampleCount);          // Sampler: after the read that completed a slice
+    void toTime(uint32_t sampleIndex, struct timeval* time);
+    unsigned long toMillis(uint32_t sampleIndex);  // Nominal ms since start, like millis()
+    double rateCorrection();                      // Multiply sample-domain frequencies by this
+    float getPpm();                               // Crystal error, + = sampling too fast
+    bool isSynced() { return synced; }
+
+private:
+    static SampleClock* instance;
+    static void onTimeSync(struct timeval* tv);
+    void addSyncPoint(const struct timeval& tv);
+    void fit();
+
+    // Sampler anchor: sample count and esp_timer time of the last read
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t anchorCount{0};
+    int64_t anchorMicros{0};
+
+    // Regression points, oldest first (SNTP callback only)
+    uint32_t pointIndex[TIMEBASE_POINTS];
+    double pointUtc[TIMEBASE_POINTS];
+    uint16_t pointCount{0};
+
+    // Published model: utc(n) = refUtc + (n - refIndex) * period
+    uint32_t refIndex{0};
+    double refUtc{0};
+    double period{1.0 / SAMPLING_FREQUENCY};
+    bool synced{false};
+};
+
+#endif // SAMPLE_CLOCK_H
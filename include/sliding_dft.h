@@ -0,0 +1,43 @@
+#ifndef SLIDING_DFT_H
+#define SLIDING_DFT_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "compact_layout.h"
+
+// Bins covered by the sliding DFT: the peak search range plus two
+// neighbours on each side (one for the Hamming kernel, one for interpolation)
+#define SDFT_FIRST_BIN (SEARCH_MIN_FREQUENCY * ANALYSIS_SIZE / SAMPLING_FREQUENCY - 2)
+#define SDFT_LAST_BIN (SEARCH_MAX_FREQUENCY * ANALYSIS_SIZE / SAMPLING_FREQUENCY + 2)
+#define SDFT_NUM_BINS (SDFT_LAST_BIN - SDFT_FIRST_BIN + 1)
+
+// Raw accumulator state, copied out by the sampler at every block boundary
+struct SlidingDftSnapshot {
+    int64_t re[SDFT_NUM_BINS];
+    int64_t im[SDFT_NUM_BINS];
+    uint32_t sampleIndex;   // Absolute index of the first sample after the window
+};
+
+// Sliding DFT over the last ANALYSIS_SIZE samples, limited to the bins
+// around the nominal frequency. Uses the modulated form: the twiddle is
+// indexed by the absolute sample index, so old and new sample share one
+// table entry and no recursive rotation is needed. Integer input, Q15
+// twiddles and 64-bit accumulators keep it exact (no drift, no resync).
+// The sampler task updates it and snapshots it into each slice header;
+// nothing else reads it, so there is no lock.
+class SlidingDft {
+public:
+    SlidingDft();
+    void update(uint32_t sampleIndex, int32_t newest, int32_t oldest);  // O(bins), sampler hot path
+    void snapshot(SlidingDftSnapshot* out);
+    static void toMagnitude(const SlidingDftSnapshot& snapshot, spectrum_t* vReal);
+
+private:
+    int64_t accRe[SDFT_NUM_BINS]{0};
+    int64_t accIm[SDFT_NUM_BINS]{0};
+    uint32_t nextIndex{0};
+    static int16_t cosTable[ANALYSIS_SIZE];  // Q15, shared by all bins
+    static void buildTable();
+};
+
+#endif // SLIDING_DFT_H
@@ -0,0 +1,64 @@
+#ifndef SOGI_FLL_H
+#define SOGI_FLL_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define SOGI_COEFF_INTERVAL 16   // Samples between coefficient updates (one tan() each)
+
+struct SogiFllOutput {
+    float frequency;     // Instantaneous frequency in Hz (sample clock)
+    float frequencyMean; // Mean since the last snapshot(..., true), removes the 2f ripple
+    float phase;         // Angle of the fundamental at sampleIndex, -pi..pi
+    float amplitude;     // Peak amplitude of the fundamental in ADC units
+    uint32_t sampleIndex;  // Absolute index of the sample the output refers to
+    bool locked;         // Amplitude above threshold and frequency inside the search range
+};
+
+// Second-order generalised integrator with frequency-locked loop
+// (Rodriguez et al.), run on every sample. The SOGI is a band-pass (v') and
+// its 90 degree companion (qv') centred on the tracked frequency, discretised
+// with the bilinear transform and prewarped so the centre is exact. The FLL
+// integrates the error v - v' correlated with qv', normalised by the
+// amplitude so the settling time (~5 / SOGI_FLL_GAIN s) does not depend on
+// the signal level. A one-pole high-pass removes the ADC offset first.
+// The instantaneous frequency carries some ripple at twice the grid
+// frequency (harmonics, noise); the block mean removes most of it.
+//
+// Per sample: a fixed handful of float multiply-adds; the prewarped
+// coefficients are refreshed every SOGI_COEFF_INTERVAL samples. Both
+// update() and snapshot() run in the sampler task, so there is no lock.
+// Diagnostic only: the slice snapshot is reported as freqFll and fllPhase,
+// the frequency, alarm and RoCoF path uses the FFT/phase estimate.
+class SogiFll {
+public:
+    SogiFll();
+    void update(uint32_t sampleIndex, int32_t sample);  // Sampler hot path
+    void snapshot(SogiFllOutput* out, bool restartMean);
+
+private:
+    // DC blocker
+    float dcPole;
+    float lastInput{0};
+    float lastHighpass{0};
+    bool primed{false};
+
+    // SOGI state and coefficients
+    float v1{0}, v2{0};       // Input history
+    float d1{0}, d2{0};       // v' history
+    float q1{0}, q2{0};       // qv' history
+    float b0{0}, a1{0}, a2{0}, qb0{0};
+    uint16_t coeffCountdown{0};
+
+    // FLL
+    float omega;              // rad/s
+    float omegaMin;
+    float omegaMax;
+    float omegaSum{0};
+    uint16_t omegaCount{0};
+
+    uint32_t nextIndex{0};
+    void updateCoefficients();
+};
+
+#endif // SOGI_FLL_H
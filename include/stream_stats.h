@@ -0,0 +1,81 @@
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "frequency_analyzer.h"
+
+// Deviation bands by |f - f0|: below STANDARD_RANGE, ALERT_RANGE,
+// LEVEL1_EMERGENCY, LEVEL2_EMERGENCY and above
+#define STATS_BANDS 5
+
+// P-square estimate of one quantile (Jain & Chlamtac) in five markers,
+// no sample storage. Exact up to five samples.
+class P2Quantile {
+public:
+    void begin(float p);
+    void add(double x);
+    double value() const;
+
+private:
+    float p;
+    uint32_t count;
+    double height[5];
+    double position[5];
+    double desired[5];
+    double increment[5];
+    double parabolic(uint8_t i, int8_t d) const;
+    double linear(uint8_t i, int8_t d) const;
+};
+
+// Running min/max/mean/variance (Welford) plus the quantile sketches
+struct StreamMoments {
+    uint32_t count;
+    double mean;
+    double m2;
+    float min;
+    float max;
+    P2Quantile quantiles[STATS_QUANTILE_COUNT];
+    void begin();
+    void add(double x);
+    float stddev() const { return count > 1 ? sqrt(m2 / (count - 1)) : 0; }
+};
+
+struct StatsSummary {
+    time_t start;                       // Interval start (UNIX s, aligned to the interval)
+    uint16_t interval;                  // Interval length in s
+    uint32_t count;                     // Valid slices
+    uint32_t invalid;                   // Slices without a valid signal
+    float freqMin, freqMax, freqMean, freqStd;
+    float freqQuantile[STATS_QUANTILE_COUNT];
+    float devMax, devMean, devStd;      // |f - f0|
+    float devQuantile[STATS_QUANTILE_COUNT];
+    uint32_t bandSlices[STATS_BANDS];
+};
+
+#define STATS_VALID_TIME 1600000000    // Slices stamped before SNTP (1970 clock) are not aggregated
+
+// Per-interval summary of the slice stream. Intervals are aligned to the
+// wall clock, so a slice in the next interval closes the current one. A
+// clock step (SNTP setting the time, or a correction of more than one
+// interval either way) discards the open interval instead of publishing
+// it under the wrong start.
+class StreamStats {
+public:
+    StreamStats();
+    uint8_t update(const FrequencyAnalysis& analysis, StatsSummary* closed);  // Up to STATS_INTERVAL_COUNT summaries
+
+private:
+    struct Aggregate {
+        time_t start;
+        uint32_t invalid;
+        uint32_t bandSlices[STATS_BANDS];
+        StreamMoments frequency;
+        StreamMoments deviation;
+    };
+    Aggregate aggregates[STATS_INTERVAL_COUNT];
+    void begin(uint8_t i, time_t start);
+    void summarize(uint8_t i, StatsSummary* out) const;
+};
+
+#endif // STREAM_STATS_H
@@ -0,0 +1,42 @@
+#ifndef ZOOM_DFT_H
+#define ZOOM_DFT_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "compact_layout.h"
+
+// Band grid: ZOOM_BINS points from SEARCH_MIN_FREQUENCY, centred mix-down
+#define ZOOM_BIN_WIDTH ((double)(SEARCH_MAX_FREQUENCY - SEARCH_MIN_FREQUENCY) / ZOOM_BINS)
+#define ZOOM_CENTER_FREQUENCY (0.5 * (SEARCH_MIN_FREQUENCY + SEARCH_MAX_FREQUENCY))
+#define ZOOM_TAPS (2 * ZOOM_DECIMATION - 1)
+#define ZOOM_OUTPUTS ((ANALYSIS_SIZE - ZOOM_TAPS) / ZOOM_DECIMATION + 1)
+
+// Zoom DFT of the analysis window over the search band only:
+//  1. complex mix-down of the band centre to 0 Hz,
+//  2. triangular (2nd order CIC) low-pass + decimation by ZOOM_DECIMATION,
+//     folded into one complex tap table,
+//  3. Hann window on the decimated baseband and a complex Goertzel per bin.
+// Magnitudes are scaled like the Hamming FFT path, so SPECTRUM_AMPLITUDE_THRESHOLD
+// applies unchanged. The dense grid keeps the interpolation error far below
+// the 1 Hz FFT grid without a bin-error fit.
+class ZoomDft {
+public:
+    ZoomDft();
+    void compute(const uint16_t* adcData, spectrum_t* magnitude);  // ZOOM_BINS values
+    static double binFrequency(double bin) { return SEARCH_MIN_FREQUENCY + bin * ZOOM_BIN_WIDTH; }
+
+private:
+    float tapRe[ZOOM_TAPS];          // Triangle * exp(-j*w0*i)
+    float tapIm[ZOOM_TAPS];
+    float blockRotRe{1};             // exp(-j*w0*R), mixer phase step per output
+    float blockRotIm{0};
+    float window[ZOOM_OUTPUTS];      // Hann over the decimated samples
+    float coeff[ZOOM_BINS];          // Goertzel 2*cos(w_k)
+    float rotRe[ZOOM_BINS];          // exp(-j*w_k) for the final Goertzel step
+    float rotIm[ZOOM_BINS];
+    float scale{1};                  // FFT-equivalent scaling
+    float baseRe[ZOOM_OUTPUTS];
+    float baseIm[ZOOM_OUTPUTS];
+};
+
+#endif // ZOOM_DFT_H
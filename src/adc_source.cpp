@@ -0,0 +1,123 @@
+#include "adc_source.h"
+#include <driver/i2s.h>
+#include <driver/adc.h>
+
+static_assert(ADC_DMA_FRAME_SAMPLES % ADC_DMA_OVERSAMPLE == 0, "DMA frame must hold whole oversampling groups");
+
+AdcSource* AdcSource::create() {
+#if ACQUISITION_MODE == ACQUISITION_DMA
+    return new DmaAdcSource();
+#elif ACQUISITION_MODE == ACQUISITION_OVERSAMPLED
+    return new OversampledAdcSource();
+#else
+    return new TimerAdcSource();
+#endif
+}
+
+// Timer
+
+TaskHandle_t TimerAdcSource::samplerTask = nullptr;
+
+// ISR context: only an IRAM-safe task notification, nothing else
+void IRAM_ATTR TimerAdcSource::onTimer() {
+    if (samplerTask == nullptr) return;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(samplerTask, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void TimerAdcSource::begin() {
+    samplerTask = xTaskGetCurrentTaskHandle();
+    pinMode(ADC_PIN, INPUT);
+
+    // Configure timer for stable 512Hz sampling with larger prescaler
+    uint32_t apb_freq = getApbFrequency();
+    uint32_t prescaler = 2;
+    uint32_t timer_divider = apb_freq / (prescaler * SAMPLING_FREQUENCY);
+
+    timer = timerBegin(0, prescaler, true);
+    timerAttachInterrupt(timer, &onTimer, true);
+    timerAlarmWrite(timer, timer_divider, true);
+    timerAlarmEnable(timer);
+
+    Serial.printf("APB Freq: %lu Hz, Timer Divider: %lu, Actual sampling rate: %.2f Hz\n",
+                  apb_freq, timer_divider, (float)apb_freq / (prescaler * timer_divider));
+}
+
+size_t TimerAdcSource::read(uint16_t* samples, size_t maxSamples) {
+    // Acts as counting semaphore: catches up if samples queued up
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    samples[0] = analogRead(ADC_PIN);
+    return 1;
+}
+
+// DMA
+
+void DmaAdcSource::begin() {
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+    config.sample_rate = SAMPLING_FREQUENCY * ADC_DMA_OVERSAMPLE;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    config.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+    config.dma_buf_count = 4;   // 3 frames of slack while the sampler runs
+    config.dma_buf_len = ADC_DMA_FRAME_SAMPLES;
+    config.use_apll = false;
+
+    if (i2s_driver_install(I2S_NUM_0, &config, 0, nullptr) != ESP_OK) {
+        Serial.println("Error installing I2S ADC driver! Restarting...");
+        delay(1000);
+        ESP.restart();
+    }
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    adc1_config_channel_atten(ADC_DMA_CHANNEL, ADC_ATTEN_DB_11);
+    i2s_set_adc_mode(ADC_UNIT_1, ADC_DMA_CHANNEL);
+    i2s_adc_enable(I2S_NUM_0);
+
+    Serial.printf("I2S ADC DMA: %u Hz raw, %u x oversampling, %u samples per frame\n",
+                  SAMPLING_FREQUENCY * ADC_DMA_OVERSAMPLE, ADC_DMA_OVERSAMPLE, ADC_DMA_FRAME_SAMPLES);
+}
+
+size_t DmaAdcSource::readFrame() {
+    size_t bytesRead = 0;
+    i2s_read(I2S_NUM_0, frame, sizeof(frame), &bytesRead, portMAX_DELAY);
+    return bytesRead / sizeof(uint16_t);
+}
+
+size_t DmaAdcSource::read(uint16_t* samples, size_t maxSamples) {
+    // Each DMA word carries the channel in the top 4 bits, 12-bit data below
+    size_t count = min(readFrame() / ADC_DMA_OVERSAMPLE, maxSamples);
+    for (size_t i = 0; i < count; i++) {
+        const uint16_t* group = &frame[i * ADC_DMA_OVERSAMPLE];
+        uint32_t sum = 0;
+        for (uint16_t j = 0; j < ADC_DMA_OVERSAMPLE; j++) {
+            sum += group[j] & 0x0FFF;
+        }
+        samples[i] = (sum + ADC_DMA_OVERSAMPLE / 2) / ADC_DMA_OVERSAMPLE;
+    }
+    return count;
+}
+
+// Group averaging is a boxcar at the raw rate
+double DmaAdcSource::gainAt(double frequency) {
+    double x = PI * frequency / ((double)SAMPLING_FREQUENCY * ADC_DMA_OVERSAMPLE);
+    return fabs(x) < 1e-12 ? 1.0 : fabs(sin(ADC_DMA_OVERSAMPLE * x) / (ADC_DMA_OVERSAMPLE * sin(x)));
+}
+
+// Oversampled
+
+size_t OversampledAdcSource::read(uint16_t* samples, size_t maxSamples) {
+    size_t raw = readFrame();
+    raw -= raw % ADC_DMA_OVERSAMPLE;
+    return decimator.process(frame, min(raw, maxSamples * ADC_DMA_OVERSAMPLE), samples);
+}
+
+bool OversampledAdcSource::getLoad(AcquisitionLoad* load) {
+    decimator.getLoad(load);
+    return true;
+}
+
+double OversampledAdcSource::gainAt(double frequency) {
+    return decimator.response(frequency);
+}
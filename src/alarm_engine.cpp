@@ -0,0 +1,187 @@
+#include "alarm_engine.h"
+#include "frequency_interpreter.h"
+#include "adc_source.h"
+
+// Frequency rules only judge settled measurements of a valid signal
+static float deviationSeverity(const FrequencyAlert& alert, float* value, float threshold) {
+    *value = alert.frequencyAnalysis.frequency - TARGET_FREQUENCY;
+    if (!alert.valid || !alert.frequencyAnalysis.isValidSignal) return 0;
+    return fabsf(*value) / threshold;
+}
+
+static float level2Severity(const FrequencyAlert& alert, float* value) {
+    return deviationSeverity(alert, value, LEVEL2_EMERGENCY_THRESHOLD);
+}
+
+static float level1Severity(const FrequencyAlert& alert, float* value) {
+    return deviationSeverity(alert, value, LEVEL1_EMERGENCY_THRESHOLD);
+}
+
+static float alertRangeSeverity(const FrequencyAlert& alert, float* value) {
+    return deviationSeverity(alert, value, ALERT_RANGE_THRESHOLD);
+}
+
+// Window closest to (or furthest beyond) its threshold; >= 10 Hz/s is not plausible
+static float rocofSeverity(const FrequencyAlert& alert, float* value) {
+    float severity = 0;
+    *value = 0;
+    if (!alert.valid || !alert.frequencyAnalysis.isValidSignal) return 0;
+    for (uint8_t w = 0; w < ROCOF_WINDOWS; w++) {
+        float rocof = alert.rocof[w];
+        if (isnan(rocof) || fabsf(rocof) >= 10) continue;
+        float s = fabsf(rocof) / RocofEngine::threshold(w);
+        if (s > severity) {
+            severity = s;
+            *value = rocof;
+        }
+    }
+    return severity;
+}
+
+// Inverse amplitude, so the peak is the weakest signal; lost always counts
+static float amplitudeSeverity(const FrequencyAlert& alert, float* value) {
+    *value = alert.frequencyAnalysis.amplitude;
+    float severity = SPECTRUM_AMPLITUDE_THRESHOLD / max(*value, 1.0f);
+    return alert.frequencyAnalysis.isValidSignal ? severity : max(severity, 1.0f);
+}
+
+// RoCoF windows already average over >= 500 ms, so no entry qualifier.
+// Within a group the most severe rule comes first.
+const AlarmRule alarmRules[ALARM_TYPES] = {
+    {"AMPL",                       "AMPL",  "%.0f",      ALARM_GROUP_AMPLITUDE, amplitudeSeverity,  ALARM_ENTER_MS, ALARM_EXIT_MS, 200},
+    {"ROCOF",                      "ROCOF", "%+.3fHz/s", ALARM_GROUP_ROCOF,     rocofSeverity,      0,              ALARM_EXIT_MS, 500},
+    {"LEVEL2_EMERGENCY_THRESHOLD", "EMG2",  "%+.3fHz",   ALARM_GROUP_DEVIATION, level2Severity,     ALARM_ENTER_MS, ALARM_EXIT_MS, 1000},
+    {"LEVEL1_EMERGENCY_THRESHOLD", "EMG1",  "%+.3fHz",   ALARM_GROUP_DEVIATION, level1Severity,     ALARM_ENTER_MS, ALARM_EXIT_MS, 1000},
+    {"ALERT_RANGE_THRESHOLD",      "ALRT",  "%+.3fHz",   ALARM_GROUP_DEVIATION, alertRangeSeverity, ALARM_ENTER_MS, ALARM_EXIT_MS, 1000},
+};
+
+const char* alarmName(AlarmType type) {
+    return type < ALARM_TYPES ? alarmRules[type].name : "none";
+}
+
+const char* alarmPhaseName(AlarmPhase phase) {
+    static const char* const names[] = {"start", "update", "end"};
+    return names[phase];
+}
+
+AlarmEngine::AlarmEngine() : state{} {}
+
+uint8_t AlarmEngine::update(const FrequencyAlert& alert, AlarmEvent* events) {
+    unsigned long now = alert.frequencyAnalysis.millis;
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < ALARM_TYPES; i++) {
+        const AlarmRule& rule = alarmRules[i];
+        RuleState& s = state[i];
+        float value;
+        float severity = rule.severity(alert, &value);
+
+        // Escalation: a more severe rule of the group holds
+        if (superseded(i)) {
+            if (s.active) {
+                s.active = false;
+                emit((AlarmType)i, ALARM_EVENT_END, now, value, &events[count++]);
+            }
+            s.pending = false;
+            continue;
+        }
+
+        if (!s.active) {
+            if (severity < 1) {
+                s.pending = false;
+                continue;
+            }
+            if (!s.pending) {
+                s.pending = true;
+                s.since = now;
+                s.start = alert.frequencyAnalysis.time;
+                s.peakSeverity = 0;
+            }
+            if (severity > s.peakSeverity) {
+                s.peakSeverity = severity;
+                s.peak = value;
+            }
+            if (now - s.since >= rule.enterMs) {
+                // De-escalation: hands over from a severe rule that is clearing
+                for (uint8_t j = 0; j < i; j++) {
+                    if (state[j].active && alarmRules[j].group == rule.group) {
+                        state[j].active = false;
+                        state[j].pending = false;
+                        emit((AlarmType)j, ALARM_EVENT_END, state[j].since, value, &events[count++]);
+                    }
+                }
+                s.active = true;
+                s.clearing = false;
+                s.startMillis = s.since;
+                s.lastReport = now;
+                emit((AlarmType)i, ALARM_EVENT_START, now, value, &events[count++]);
+            }
+            continue;
+        }
+
+        if (severity > s.peakSeverity) {
+            s.peakSeverity = severity;
+            s.peak = value;
+        }
+        if (severity < ALARM_EXIT_RATIO) {
+            if (!s.clearing) {
+                s.clearing = true;
+                s.since = now;
+            }
+            if (now - s.since >= rule.exitMs) {
+                s.active = false;
+                s.pending = false;
+                emit((AlarmType)i, ALARM_EVENT_END, s.since, value, &events[count++]);
+            }
+            continue;
+        }
+        s.clearing = false;
+        if (now - s.lastReport >= ALARM_UPDATE_MS) {
+            s.lastReport = now;
+            emit((AlarmType)i, ALARM_EVENT_UPDATE, now, value, &events[count++]);
+        }
+    }
+    return count;
+}
+
+// A more severe rule of the same group is active and not clearing
+bool AlarmEngine::superseded(uint8_t i) const {
+    for (uint8_t j = 0; j < i; j++) {
+        if (state[j].active && !state[j].clearing && alarmRules[j].group == alarmRules[i].group) return true;
+    }
+    return false;
+}
+
+AlarmType AlarmEngine::mostSevere() const {
+    for (uint8_t i = 0; i < ALARM_TYPES; i++) {
+        if (state[i].active) return (AlarmType)i;
+    }
+    return ALARM_NONE;
+}
+
+// An ended event lasts until its condition first cleared
+void AlarmEngine::emit(AlarmType type, AlarmPhase phase, unsigned long now, float value, AlarmEvent* event) {
+    const AlarmRule& rule = alarmRules[type];
+    const RuleState& s = state[type];
+    event->type = type;
+    event->phase = phase;
+    event->start = s.start;
+    event->durationMs = now - s.startMillis;
+    event->value = value;
+    event->peak = s.peak;
+
+    // One LCD row: label (5) value (10) duration (3), e.g. "ROCOF +0.512Hz/s 12m"
+    char text[11];
+    snprintf(text, sizeof(text), rule.format, phase == ALARM_EVENT_START ? value : s.peak);
+    if (phase == ALARM_EVENT_END) {
+        unsigned long seconds = event->durationMs / 1000;
+        char duration[8];
+        if (seconds < 100) snprintf(duration, sizeof(duration), "%lus", seconds);
+        else if (seconds < 6000) snprintf(duration, sizeof(duration), "%lum", seconds / 60);
+        else if (seconds < 360000) snprintf(duration, sizeof(duration), "%luh", seconds / 3600);
+        else snprintf(duration, sizeof(duration), "%lud", seconds / 86400);
+        snprintf(event->message, sizeof(event->message), "%s %s %s", rule.label, text, duration);
+    } else {
+        snprintf(event->message, sizeof(event->message), "%s %s", rule.label, text);
+    }
+}
@@ -0,0 +1,114 @@
+#include "decimator.h"
+
+static_assert(ADC_DMA_OVERSAMPLE % DECIMATOR_FIR_FACTOR == 0, "Oversampling must split into CIC x FIR factor");
+static_assert(DECIMATOR_FIR_TAPS % DECIMATOR_FIR_FACTOR == 0, "FIR taps must split into whole polyphase branches");
+
+Decimator::Decimator() {
+    // Windowed-sinc low-pass at the output Nyquist frequency (relative to
+    // the CIC output rate), Blackman for ~75 dB stopband
+    const uint16_t taps = DECIMATOR_FIR_TAPS;
+    const double fc = 0.5 / DECIMATOR_FIR_FACTOR;
+    const double centre = 0.5 * (taps - 1);
+    double h[DECIMATOR_FIR_TAPS];
+    double sum = 0;
+    for (uint16_t n = 0; n < taps; n++) {
+        double x = n - centre;
+        double sinc = fabs(x) < 1e-9 ? 2 * fc : sin(TWO_PI * fc * x) / (PI * x);
+        double w = 0.42 - 0.5 * cos(TWO_PI * n / (taps - 1)) + 0.08 * cos(2 * TWO_PI * n / (taps - 1));
+        h[n] = sinc * w;
+        sum += h[n];
+    }
+
+    // Branch taps are stored time-reversed, so the dot product runs forward
+    // over the history: y[m] = sum_j even[j] * e[m + j] + odd[j] * o[m + j]
+    for (uint16_t j = 0; j < DECIMATOR_PHASE_TAPS; j++) {
+        evenTaps[j] = h[2 * (DECIMATOR_PHASE_TAPS - 1 - j)] / sum;
+        oddTaps[j] = h[2 * (DECIMATOR_PHASE_TAPS - 1 - j) + 1] / sum;
+    }
+
+    // Remove the CIC gain R^N, keep DECIMATOR_EXTRA_BITS of extra resolution
+    double cicGain = pow(DECIMATOR_CIC_FACTOR, DECIMATOR_CIC_ORDER);
+    outputScale = (1 << DECIMATOR_EXTRA_BITS) / cicGain;
+
+    double framePeriod = (double)ADC_DMA_FRAME_SAMPLES / (SAMPLING_FREQUENCY * ADC_DMA_OVERSAMPLE);
+    budgetCycles = framePeriod * CPU_FREQUENCY_MHZ * 1e6 * DECIMATOR_BUDGET_PERCENT / 100;
+}
+
+size_t Decimator::process(const uint16_t* raw, size_t count, uint16_t* out) {
+    uint32_t startCycles = ESP.getCycleCount();
+
+    // Stage 1: CIC, de-interleaved straight into the branch histories
+    float* even = &evenHistory[DECIMATOR_PHASE_TAPS - 1];
+    float* odd = &oddHistory[DECIMATOR_PHASE_TAPS];
+    size_t cicCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t x = raw[i] & 0x0FFF;  // I2S ADC word: channel in the top 4 bits
+        integrator[0] += x;
+        integrator[1] += integrator[0];
+        integrator[2] += integrator[1];
+        if (++cicPhase < DECIMATOR_CIC_FACTOR) continue;
+        cicPhase = 0;
+
+        uint32_t y = integrator[2];
+        for (uint16_t s = 0; s < DECIMATOR_CIC_ORDER; s++) {
+            uint32_t delayed = comb[s];
+            comb[s] = y;
+            y -= delayed;
+        }
+        if (cicCount & 1) {
+            odd[cicCount >> 1] = (float)(int32_t)y;
+        } else {
+            even[cicCount >> 1] = (float)(int32_t)y;
+        }
+        cicCount++;
+    }
+
+    // Stage 2: both polyphase branches, one output per CIC pair
+    size_t outputs = cicCount / DECIMATOR_FIR_FACTOR;
+    for (size_t m = 0; m < outputs; m++) {
+        const float* e = &evenHistory[m];
+        const float* o = &oddHistory[m];
+        float acc = 0;
+        for (uint16_t j = 0; j < DECIMATOR_PHASE_TAPS; j++) {
+            acc += evenTaps[j] * e[j] + oddTaps[j] * o[j];
+        }
+        float v = acc * outputScale + 0.5f;
+        out[m] = v <= 0 ? 0 : (v >= 65535 ? 65535 : (uint16_t)v);
+    }
+
+    // Keep the tail as history for the next frame
+    memmove(evenHistory, &evenHistory[outputs], (DECIMATOR_PHASE_TAPS - 1) * sizeof(float));
+    memmove(oddHistory, &oddHistory[outputs], DECIMATOR_PHASE_TAPS * sizeof(float));
+
+    uint32_t cycles = ESP.getCycleCount() - startCycles;
+    lastCycles = cycles;
+    if (cycles > peakCycles) peakCycles = cycles;
+    if (cycles > budgetCycles) overruns++;
+    return outputs;
+}
+
+void Decimator::getLoad(AcquisitionLoad* load) {
+    load->lastCycles = lastCycles;
+    load->peakCycles = peakCycles;
+    load->budgetCycles = budgetCycles;
+    load->overruns = overruns;
+    peakCycles = lastCycles;
+}
+
+double Decimator::response(double frequency) {
+    // CIC at the raw rate
+    const double rawRate = (double)SAMPLING_FREQUENCY * ADC_DMA_OVERSAMPLE;
+    double x = PI * frequency / rawRate;
+    double cic = fabs(x) < 1e-12 ? 1.0 : sin(DECIMATOR_CIC_FACTOR * x) / (DECIMATOR_CIC_FACTOR * sin(x));
+
+    // FIR at the CIC output rate, taps re-interleaved from the branches
+    const double firRate = rawRate / DECIMATOR_CIC_FACTOR;
+    double re = 0;
+    double im = 0;
+    for (uint16_t j = 0; j < DECIMATOR_PHASE_TAPS; j++) {
+        uint16_t n = 2 * (DECIMATOR_PHASE_TAPS - 1 - j);
+        re += evenTaps[j] * cos(TWO_PI * frequency * n / firRate) + oddTaps[j] * cos(TWO_PI * frequency * (n + 1) / firRate);
+        im -= evenTaps[j] * sin(TWO_PI * frequency * n / firRate) + oddTaps[j] * sin(TWO_PI * frequency * (n + 1) / firRate);
+    }
+    return fabs(pow(cic, DECIMATOR_CIC_ORDER)) * sqrt(re * re + im * im);
+}
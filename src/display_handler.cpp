@@ -2,6 +2,8 @@
 
 DisplayHandler::DisplayHandler() 
     : lcd(LCD_I2C_ADDR, LCD_COLS, LCD_ROWS),
+      glyphsSet(0),
+      glyphsDirty(0),
       hasAnalysis{0},
       currentAnalysis(FrequencyAnalysis{}),
       currentWifiStatus(false),
@@ -29,21 +31,21 @@ void DisplayHandler::begin() {
     lcd.init();
     lcd.backlight();
     lcd.clear();
-    lcd.setCursor(0, 0);
-    lcd.print("Freq Sensor");
-    lcd.setCursor(0, 1);
-    lcd.print("Starting...");
-    lcd.setCursor(0, 2);
-    lcd.print("Calvin Koecher");
-    lcd.setCursor(0, 3);
-    lcd.print("10.2025");
+    memset(shadow, ' ', sizeof(shadow));  // What clear() left on the LCD
+
+    clearFrame();
+    print(0, 0, "Freq Sensor");
+    print(0, 1, "Starting...");
+    print(0, 2, "Calvin Koecher");
+    print(0, 3, "10.2025");
 
     // Create custom chars
-    lcd.createChar(0, wifiIcon);
-    lcd.createChar(1, mqttIcon);
-    lcd.createChar(2, clockIcon);
-    lcd.createChar(3, full);
-    lcd.createChar(4, horzLine);
+    defineGlyph(0, wifiIcon);
+    defineGlyph(1, mqttIcon);
+    defineGlyph(2, clockIcon);
+    defineGlyph(3, full);
+    defineGlyph(4, horzLine);
+    flush();
 
     // Init Pins
     pinMode(BUTTON_UP_PIN, INPUT_PULLUP);
@@ -115,32 +117,88 @@ void DisplayHandler::handleDownButton() {
 void DisplayHandler::handleMuteButton() {
     numAlarms = 0;
     scrollPosition = 0;
-    lcd.clear();
     needsUpdate = true;
 }
 
-// Method to add an alarms
-void DisplayHandler::addAlert(FrequencyAlert alarm) {
+// New events get a list entry; updates and the end rewrite that entry
+void DisplayHandler::addEvent(const AlarmEvent& event) {
 
-    // Limit the Rate an Alarm is Added
-    if (millis() - lastAlarmAdded > MAX_ALARM_INTERVAL_MS) {
-
-        // Add Alarm to Ringbuffer
-        writeIndex = (writeIndex + 1) % MAX_ALARMS;
-        if(numAlarms < MAX_ALARMS){
-            numAlarms = numAlarms + 1;
+    if (event.phase != ALARM_EVENT_START) {
+        AlarmRecord* record = findRecord(event);
+        if (record) {
+            memcpy(record->message, event.message, sizeof(record->message));
+            needsUpdate = true;
         }
-        alarmHistory[writeIndex] = alarm;
+        return;
+    }
 
-        // Scroll Helper - Let Scroll run if not 0
-        if(scrollPosition) scrollPosition = (scrollPosition + 1) % numAlarms;
-        needsUpdate = true;
-        lastAlarmAdded = millis();
+    // Add Alarm to Ringbuffer
+    writeIndex = (writeIndex + 1) % MAX_ALARMS;
+    if(numAlarms < MAX_ALARMS){
+        numAlarms = numAlarms + 1;
+    }
+    AlarmRecord& record = alarmHistory[writeIndex];
+    record.time = event.start.tv_sec;
+    record.type = event.type;
+    memcpy(record.message, event.message, sizeof(record.message));
 
+    // Scroll Helper - Let Scroll run if not 0
+    if(scrollPosition) scrollPosition = (scrollPosition + 1) % numAlarms;
+    needsUpdate = true;
+    lastAlarmAdded = millis();
+}
+
+// Entry of a running event, newest first; null if muted or overwritten
+AlarmRecord* DisplayHandler::findRecord(const AlarmEvent& event) {
+    for (uint16_t n = 0; n < numAlarms; n++) {
+        AlarmRecord& record = alarmHistory[(writeIndex + MAX_ALARMS - n) % MAX_ALARMS];
+        if (record.type == event.type && record.time == event.start.tv_sec) return &record;
     }
+    return nullptr;
 }
 
 
+void DisplayHandler::clearFrame() {
+    memset(frame, ' ', sizeof(frame));
+}
+
+// Text into the frame, clipped at the end of the row
+void DisplayHandler::print(uint8_t col, uint8_t row, const char* text) {
+    for (; col < LCD_COLS && *text; ++col) frame[row][col] = *text++;
+}
+
+// Queues a CGRAM upload only if the slot's definition changes
+void DisplayHandler::defineGlyph(uint8_t slot, const uint8_t* rows) {
+    uint8_t bit = 1 << slot;
+    if ((glyphsSet & bit) && memcmp(glyphs[slot], rows, 8) == 0) return;
+    memcpy(glyphs[slot], rows, 8);
+    glyphsSet |= bit;
+    glyphsDirty |= bit;
+}
+
+// Sends the difference between frame and shadow. Each run of changed cells
+// costs one cursor command; the cursor is never left to advance across a
+// row end, as the DDRAM order of a 20x4 is row 0, 2, 1, 3.
+void DisplayHandler::flush() {
+    // Glyphs first: createChar leaves the address counter in CGRAM, so a
+    // cell write must not follow it without a setCursor
+    for (uint8_t slot = 0; slot < LCD_GLYPHS; ++slot) {
+        if (glyphsDirty & (1 << slot)) lcd.createChar(slot, glyphs[slot]);
+    }
+    glyphsDirty = 0;
+
+    for (uint8_t row = 0; row < LCD_ROWS; ++row) {
+        int8_t cursor = -1;             // Column the next write lands on
+        for (uint8_t col = 0; col < LCD_COLS; ++col) {
+            if (frame[row][col] == shadow[row][col]) continue;
+            if (cursor != col) lcd.setCursor(col, row);
+            lcd.write(frame[row][col]);
+            shadow[row][col] = frame[row][col];
+            cursor = col + 1;
+        }
+    }
+}
+
 // Draw centered frequency bar using only CGRAM slot 7 for partial fill
 void DisplayHandler::drawFrequencyBar(uint8_t row, float value) {
     const float MIN = TARGET_FREQUENCY - ALERT_RANGE_THRESHOLD;
@@ -154,9 +212,8 @@ void DisplayHandler::drawFrequencyBar(uint8_t row, float value) {
     // Map to pixel 0-99
     int pixel = (int)round((value - MIN) / (MAX - MIN) * (LCD_PIXELS - 1));
 
-    // Clear line buffer
-    uint8_t chars[LCD_COLS];
-    for (uint8_t i = 0; i < LCD_COLS; ++i) chars[i] = ' ';
+    // Row of the frame, already cleared
+    uint8_t* chars = frame[row];
 
     // Center marker
     int centerChar = CENTER / 5;
@@ -184,15 +241,11 @@ void DisplayHandler::drawFrequencyBar(uint8_t row, float value) {
         uint8_t rows[8];
         for (uint8_t i = 0; i < 8; ++i) rows[i] = mask;
         rows[7] = B00000; // Always Empty
-        lcd.createChar(7, rows);
+        defineGlyph(LCD_GLYPH_BAR, rows);
 
         int pos = centerChar + (fullChars + 1) * dir;
-        if (pos >= 0 && pos < LCD_COLS) chars[pos] = 7;
+        if (pos >= 0 && pos < LCD_COLS) chars[pos] = LCD_GLYPH_BAR;
     }
-
-    // Print the line
-    lcd.setCursor(0, row);
-    for (uint8_t i = 0; i < LCD_COLS; ++i) lcd.write(chars[i]);
 }
 
 void DisplayHandler::loop() {
@@ -207,10 +260,7 @@ void DisplayHandler::loop() {
     // Drive Buzzer (setBuzzer only touches LEDC on state changes)
     uint32_t buzzerFreq = 0;
     if (numAlarms && millis() - lastAlarmAdded <= BUZZER_DURATION_MS){
-        const char* type = alarmHistory[writeIndex].alertType;
-        if (strcmp(type, "AMPL") == 0)       buzzerFreq = 200;
-        else if (strcmp(type, "ROCOF") == 0) buzzerFreq = 500;
-        else                                 buzzerFreq = 1000;
+        buzzerFreq = alarmRules[alarmHistory[writeIndex].type].buzzerHz;
     }
     setBuzzer(buzzerFreq);
 
@@ -221,41 +271,30 @@ void DisplayHandler::loop() {
     // Global Vars
     char message[LCD_COLS]{' '};
     uint16_t i = (writeIndex + MAX_ALARMS - scrollPosition) % MAX_ALARMS;
+    clearFrame();
 
     // First line: Always show current frequency
     if (hasAnalysis && currentAnalysis.isValidSignal) {
-        snprintf(message, LCD_COLS, "Freq: %.3f %-20s", currentAnalysis.frequency, "Hz");
+        snprintf(message, LCD_COLS, "Freq: %.3f Hz", currentAnalysis.frequency);
     } else {
-        snprintf(message, LCD_COLS, "%-20s","No Signal");
+        snprintf(message, LCD_COLS, "No Signal");
     }
-    lcd.setCursor(0, 0);
-    lcd.print(message);
+    print(0, 0, message);
 
     // First line: Show Connection Status
-    lcd.setCursor(17, 0); lcd.write(currentWifiStatus ? byte(0) : ' '); // WiFi
-    lcd.setCursor(18, 0); lcd.write(currentMqttStatus ? byte(1) : ' '); // MQTT
-    lcd.setCursor(19, 0); lcd.write(currentNTPStatus  ? byte(2) : ' '); // Clock
+    frame[0][17] = currentWifiStatus ? 0 : ' '; // WiFi
+    frame[0][18] = currentMqttStatus ? 1 : ' '; // MQTT
+    frame[0][19] = currentNTPStatus  ? 2 : ' '; // Clock
 
     if (numAlarms) {
 
-        // Second line: Show alarm numbers
-        lcd.setCursor(0, 1);
+        // Second line: Show alarm numbers, centered between dashes
         snprintf(message, LCD_COLS, "MSG %d/%d", scrollPosition + 1 , numAlarms);
-        int textLen = strlen(message);
-        int totalWidth = 20;
-        int dashCount = (totalWidth - textLen) / 2;
-        // Left padding
-        for (int i = 0; i < dashCount; i++) lcd.print('-');
-        // The message part
-        lcd.print(message);
-        // Right padding (if width is odd)
-        while ((dashCount + textLen) < totalWidth) {
-            lcd.print('-');
-            dashCount++;
-        }
+        memset(frame[1], '-', LCD_COLS);
+        print((LCD_COLS - strlen(message)) / 2, 1, message);
 
         // Convert epoch time to local time and format with milliseconds
-        time_t epoch = alarmHistory[i].frequencyAnalysis.time.tv_sec;
+        time_t epoch = alarmHistory[i].time;
         struct tm timeinfo;
         localtime_r(&epoch, &timeinfo);
         
@@ -266,38 +305,22 @@ void DisplayHandler::loop() {
             timeinfo.tm_hour,
             timeinfo.tm_min,
             timeinfo.tm_sec);
-        lcd.setCursor(0, 2);
-        lcd.print(message);
+        print(0, 2, message);
 
         // Forth line: Show alarm if any
-        snprintf(message, LCD_COLS, "%-20s", alarmHistory[i].message);
-        lcd.setCursor(0, 3);
-        lcd.print("                    ");
-        lcd.setCursor(0, 3);
-        lcd.print(message);
+        print(0, 3, alarmHistory[i].message);
 
     }else if(hasAnalysis && currentAnalysis.isValidSignal){
-        // Second line: Darw Line
-        lcd.setCursor(0, 1);  // row = 0..3 for a 20x4 display
-        for (int i = 0; i < 20; i++) {
-            lcd.write(byte(4));  // write custom char slot 4 (0–7 valid)
-        }
+        // Second line: Darw Line (custom char slot 4)
+        memset(frame[1], 4, LCD_COLS);
 
         // Third line: Draw Freq Bar
         drawFrequencyBar(2,currentAnalysis.frequency);
 
         //Forth line: Draw Scala
-        lcd.setCursor(0, 3);
-        lcd.print("|-200mHz  | +200mHz|");
-    }else{
-        // Clear everything
-        lcd.setCursor(0, 1);
-        lcd.print("                    ");
-        lcd.setCursor(0, 2);
-        lcd.print("                    ");
-        lcd.setCursor(0, 3);
-        lcd.print("                    ");
+        print(0, 3, "|-200mHz  | +200mHz|");
     }
-    
+
+    flush();
     needsUpdate = false;
-}
\ No newline at end of file
+}
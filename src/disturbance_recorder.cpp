@@ -0,0 +1,140 @@
+#include "disturbance_recorder.h"
+
+#define RECORDER_SLOTS (RECORDER_SLICES + 1)
+#define FREQUENCY_LSB 0.0001   // Hz per count of the FREQ channel, offset TARGET_FREQUENCY
+
+DisturbanceRecorder::DisturbanceRecorder() {
+    reset(buffers[0]);
+    reset(buffers[1]);
+}
+
+void DisturbanceRecorder::reset(DisturbanceCapture& c) {
+    c.head = 0;
+    c.slices = 0;
+    c.postRemaining = 0;
+    c.triggered = false;
+}
+
+// Staged into the free slot; only commitSlice() makes it part of the ring.
+// Oversampled acquisition is reduced to 12 bits.
+void DisturbanceRecorder::stageBlock(const uint16_t* block) {
+    uint8_t* out = buffers[live].samples[buffers[live].head];
+    for (uint16_t i = 0; i < PHASE_BLOCK_SIZE; i += 2) {
+        uint16_t a = block[i] >> (ADC_SAMPLE_BITS - 12);
+        uint16_t b = block[i + 1] >> (ADC_SAMPLE_BITS - 12);
+        *out++ = a & 0xFF;
+        *out++ = (a >> 8) | ((b & 0x0F) << 4);
+        *out++ = b >> 4;
+    }
+}
+
+void DisturbanceRecorder::commitSlice(uint32_t sampleIndex, float frequency, const timeval& time) {
+    DisturbanceCapture& c = buffers[live];
+
+    // Dropped slice: samples are no longer contiguous, start over. A running
+    // capture cannot be completed and is lost.
+    if (c.slices && sampleIndex - c.lastIndex != PHASE_BLOCK_SIZE) {
+        if (c.triggered) dropped++;
+        uint16_t staged = c.head;
+        reset(c);
+        memcpy(c.samples[0], c.samples[staged], RECORDER_SLICE_BYTES);
+    }
+
+    c.frequency[c.head] = frequency;
+    c.head = (c.head + 1) % RECORDER_SLOTS;
+    if (c.slices < RECORDER_SLICES) c.slices++;
+    c.lastIndex = sampleIndex;
+    if (!c.triggered) {
+        c.trigger = time;
+        return;
+    }
+    if (--c.postRemaining) return;
+
+    // Capture complete: trigger at the end of the slice that raised it
+    c.triggerSample = (uint32_t)(c.slices - RECORDER_POST_SLICES) * PHASE_BLOCK_SIZE - 1;
+    if (frozenState.load(std::memory_order_acquire)) {
+        dropped++;
+        c.triggered = false;
+        return;
+    }
+    frozen = live;
+    live ^= 1;
+    reset(buffers[live]);
+    frozenState.store(true, std::memory_order_release);
+}
+
+// Called after the slice that raised the event was committed
+void DisturbanceRecorder::trigger(const AlarmEvent& event) {
+    DisturbanceCapture& c = buffers[live];
+    if (c.triggered || c.slices == 0) return;
+    c.triggered = true;
+    c.postRemaining = RECORDER_POST_SLICES;
+    c.type = event.type;
+}
+
+// Slot of the n-th committed slice, oldest first
+static uint16_t slotOf(const DisturbanceCapture& c, uint32_t slice) {
+    return (c.head + RECORDER_SLOTS - c.slices + slice) % RECORDER_SLOTS;
+}
+
+uint16_t DisturbanceRecorder::sampleAt(const DisturbanceCapture& c, uint32_t n) {
+    uint16_t slot = slotOf(c, n / PHASE_BLOCK_SIZE);
+    uint16_t i = n % PHASE_BLOCK_SIZE;
+    const uint8_t* pair = &c.samples[slot][(i / 2) * 3];
+    return (i & 1) ? (pair[1] >> 4) | (pair[2] << 4) : pair[0] | ((pair[1] & 0x0F) << 8);
+}
+
+static int formatTime(char* out, size_t size, int64_t us) {
+    time_t seconds = us / 1000000;
+    struct tm t;
+    gmtime_r(&seconds, &t);
+    return snprintf(out, size, "%02d/%02d/%04d,%02d:%02d:%02d.%06ld\n", t.tm_mday, t.tm_mon + 1, t.tm_year + 1900,
+                    t.tm_hour, t.tm_min, t.tm_sec, (long)(us % 1000000));
+}
+
+// IEEE C37.111-1999 configuration: raw ADC counts and the per-slice
+// frequency, binary data, UTC
+size_t DisturbanceRecorder::formatCfg(char* out, size_t size) {
+    const DisturbanceCapture& c = buffers[frozen];
+    int64_t triggerUs = (int64_t)c.trigger.tv_sec * 1000000 + c.trigger.tv_usec;
+    int64_t firstUs = triggerUs - (int64_t)c.triggerSample * 1000000 / SAMPLING_FREQUENCY;
+
+    int len = snprintf(out, size,
+                       "%s,%s,1999\n"
+                       "2,2A,0D\n"
+                       "1,ADC,,,counts,1.000000,0.000000,0,0,4095,1,1,P\n"
+                       "2,FREQ,,,Hz,%.6f,%.6f,0,-32767,32767,1,1,P\n"
+                       "%g\n"
+                       "1\n"
+                       "%d,%lu\n",
+                       SENSOR_ID, alarmName(c.type), FREQUENCY_LSB, (double)TARGET_FREQUENCY,
+                       (double)TARGET_FREQUENCY, SAMPLING_FREQUENCY, (unsigned long)records());
+    if (len < (int)size) len += formatTime(out + len, size - len, firstUs);
+    if (len < (int)size) len += formatTime(out + len, size - len, triggerUs);
+    if (len < (int)size) len += snprintf(out + len, size - len, "BINARY\n1\n");
+    return len < (int)size ? len : 0;
+}
+
+// Little-endian records: uint32 sample number (from 1), uint32 time in us,
+// int16 ADC, int16 frequency (0x8000 = missing, per the 1999 standard)
+size_t DisturbanceRecorder::formatDat(uint8_t* out, uint32_t firstRecord, uint32_t count) {
+    const DisturbanceCapture& c = buffers[frozen];
+    uint8_t* p = out;
+    for (uint32_t n = firstRecord; n < firstRecord + count && n < records(); n++) {
+        uint32_t number = n + 1;
+        uint32_t us = (uint64_t)n * 1000000 / SAMPLING_FREQUENCY;
+        int16_t adc = sampleAt(c, n);
+        float frequency = c.frequency[slotOf(c, n / PHASE_BLOCK_SIZE)];
+        int16_t code = (int16_t)0x8000;
+        if (!isnan(frequency)) {
+            code = (int16_t)constrain(lround((frequency - TARGET_FREQUENCY) / FREQUENCY_LSB), -32767L, 32767L);
+        }
+        for (uint8_t b = 0; b < 4; b++) *p++ = number >> (8 * b);
+        for (uint8_t b = 0; b < 4; b++) *p++ = us >> (8 * b);
+        *p++ = adc & 0xFF;
+        *p++ = (uint16_t)adc >> 8;
+        *p++ = code & 0xFF;
+        *p++ = (uint16_t)code >> 8;
+    }
+    return p - out;
+}
@@ -0,0 +1,211 @@
+#include "fft_kernel.h"
+#include "adc_source.h"
+#if FFT_KERNEL_SELFTEST
+#include <arduinoFFT.h>
+#endif
+
+static_assert((ANALYSIS_SIZE & (ANALYSIS_SIZE - 1)) == 0, "Real FFT needs a power-of-two window");
+
+#if FFT_KERNEL == FFT_KERNEL_Q15
+// Samples are brought to 14 bits (one bit of headroom for butterfly growth).
+// Every stage halves, so the transform output is scaled by 2^14 / 2^bits / N_half.
+static const int kInputLeftShift = ADC_SAMPLE_BITS < 14 ? 14 - ADC_SAMPLE_BITS : 0;
+static const int kInputRightShift = ADC_SAMPLE_BITS > 14 ? ADC_SAMPLE_BITS - 14 : 0;
+int16_t RealFft::window[ANALYSIS_SIZE / 2];
+int16_t RealFft::twiddleRe[REAL_FFT_HALF];
+int16_t RealFft::twiddleIm[REAL_FFT_HALF];
+#else
+float RealFft::window[ANALYSIS_SIZE / 2];
+float RealFft::twiddleRe[REAL_FFT_HALF];
+float RealFft::twiddleIm[REAL_FFT_HALF];
+#endif
+uint16_t RealFft::bitReverse[REAL_FFT_HALF];
+bool RealFft::tablesBuilt = false;
+
+RealFft::RealFft() {
+    buildTables();
+}
+
+void RealFft::buildTables() {
+    if (tablesBuilt) return;
+
+    // Same Hamming definition as arduinoFFT (symmetric, N-1 denominator)
+    for (uint16_t i = 0; i < ANALYSIS_SIZE / 2; i++) {
+        double w = 0.54 - 0.46 * cos(TWO_PI * i / (ANALYSIS_SIZE - 1));
+#if FFT_KERNEL == FFT_KERNEL_Q15
+        window[i] = (int16_t)lround(32767.0 * w);
+#else
+        window[i] = (float)w;
+#endif
+    }
+
+    // W_N^k for k < N/2; the half-size FFT uses every second entry
+    for (uint16_t k = 0; k < REAL_FFT_HALF; k++) {
+        double c = cos(TWO_PI * k / ANALYSIS_SIZE);
+        double s = -sin(TWO_PI * k / ANALYSIS_SIZE);
+#if FFT_KERNEL == FFT_KERNEL_Q15
+        twiddleRe[k] = (int16_t)lround(32767.0 * c);
+        twiddleIm[k] = (int16_t)lround(32767.0 * s);
+#else
+        twiddleRe[k] = (float)c;
+        twiddleIm[k] = (float)s;
+#endif
+    }
+
+    uint16_t bits = 0;
+    while ((1u << bits) < REAL_FFT_HALF) bits++;
+    for (uint16_t i = 0; i < REAL_FFT_HALF; i++) {
+        uint16_t r = 0;
+        for (uint16_t b = 0; b < bits; b++) {
+            if (i & (1u << b)) r |= 1u << (bits - 1 - b);
+        }
+        bitReverse[i] = r;
+    }
+
+    tablesBuilt = true;
+}
+
+// DC removal, window and even/odd packing in one pass, written straight
+// into bit-reversed order
+void RealFft::load(const uint16_t* adcData) {
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) {
+        sum += adcData[i];
+    }
+
+#if FFT_KERNEL == FFT_KERNEL_Q15
+    int32_t avg = (sum + ANALYSIS_SIZE / 2) / ANALYSIS_SIZE;
+    for (uint16_t n = 0; n < REAL_FFT_HALF; n++) {
+        uint16_t i0 = 2 * n;
+        uint16_t i1 = 2 * n + 1;
+        int32_t w0 = window[i0 < ANALYSIS_SIZE / 2 ? i0 : ANALYSIS_SIZE - 1 - i0];
+        int32_t w1 = window[i1 < ANALYSIS_SIZE / 2 ? i1 : ANALYSIS_SIZE - 1 - i1];
+        int32_t x0 = ((adcData[i0] - avg) << kInputLeftShift) >> kInputRightShift;
+        int32_t x1 = ((adcData[i1] - avg) << kInputLeftShift) >> kInputRightShift;
+        re[bitReverse[n]] = (int16_t)((x0 * w0 + (1 << 14)) >> 15);
+        im[bitReverse[n]] = (int16_t)((x1 * w1 + (1 << 14)) >> 15);
+    }
+#else
+    float avg = (float)sum / ANALYSIS_SIZE;
+    for (uint16_t n = 0; n < REAL_FFT_HALF; n++) {
+        uint16_t i0 = 2 * n;
+        uint16_t i1 = 2 * n + 1;
+        float w0 = window[i0 < ANALYSIS_SIZE / 2 ? i0 : ANALYSIS_SIZE - 1 - i0];
+        float w1 = window[i1 < ANALYSIS_SIZE / 2 ? i1 : ANALYSIS_SIZE - 1 - i1];
+        re[bitReverse[n]] = (adcData[i0] - avg) * w0;
+        im[bitReverse[n]] = (adcData[i1] - avg) * w1;
+    }
+#endif
+}
+
+// In-place radix-2 DIT over the bit-reversed half-size sequence
+void RealFft::transform() {
+    for (uint16_t size = 2; size <= REAL_FFT_HALF; size <<= 1) {
+        uint16_t half = size >> 1;
+        uint16_t step = ANALYSIS_SIZE / size;  // W_size^j = W_N^(j*N/size)
+        for (uint16_t start = 0; start < REAL_FFT_HALF; start += size) {
+            for (uint16_t j = 0; j < half; j++) {
+                uint16_t a = start + j;
+                uint16_t b = a + half;
+#if FFT_KERNEL == FFT_KERNEL_Q15
+                int32_t wr = twiddleRe[j * step];
+                int32_t wi = twiddleIm[j * step];
+                int32_t tr = (re[b] * wr - im[b] * wi + (1 << 14)) >> 15;
+                int32_t ti = (re[b] * wi + im[b] * wr + (1 << 14)) >> 15;
+                int32_t ar = re[a];
+                int32_t ai = im[a];
+                re[a] = (int16_t)((ar + tr) >> 1);
+                im[a] = (int16_t)((ai + ti) >> 1);
+                re[b] = (int16_t)((ar - tr) >> 1);
+                im[b] = (int16_t)((ai - ti) >> 1);
+#else
+                float wr = twiddleRe[j * step];
+                float wi = twiddleIm[j * step];
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+#endif
+            }
+        }
+    }
+}
+
+// Magnitudes for firstBin..lastBin only (all < N/2). The real spectrum is
+// split from the packed one per bin:
+//   X[k] = (Z[k] + Z*[M-k]) / 2 + W_N^k * (Z[k] - Z*[M-k]) / 2j
+void RealFft::magnitude(const uint16_t* adcData, spectrum_t* vReal, uint16_t firstBin, uint16_t lastBin) {
+    load(adcData);
+    transform();
+    magnitudeRange(vReal, firstBin, lastBin);
+}
+
+void RealFft::magnitudeRange(spectrum_t* vReal, uint16_t firstBin, uint16_t lastBin) {
+#if FFT_KERNEL == FFT_KERNEL_Q15
+    const float scale = (float)REAL_FFT_HALF * (1 << kInputRightShift) / (1 << kInputLeftShift) / 32767.0f;
+#endif
+    for (uint16_t k = firstBin; k <= lastBin && k < REAL_FFT_HALF; k++) {
+        uint16_t m = (REAL_FFT_HALF - k) & (REAL_FFT_HALF - 1);
+        float aRe = re[k];
+        float aIm = im[k];
+        float bRe = re[m];
+        float bIm = -im[m];
+        float eRe = 0.5f * (aRe + bRe);
+        float eIm = 0.5f * (aIm + bIm);
+        float oRe = 0.5f * (aIm - bIm);
+        float oIm = -0.5f * (aRe - bRe);
+        float wr = twiddleRe[k];
+        float wi = twiddleIm[k];
+#if FFT_KERNEL == FFT_KERNEL_Q15
+        float xRe = eRe * 32767.0f + oRe * wr - oIm * wi;
+        float xIm = eIm * 32767.0f + oRe * wi + oIm * wr;
+        vReal[k] = sqrtf(xRe * xRe + xIm * xIm) * scale;
+#else
+        float xRe = eRe + oRe * wr - oIm * wi;
+        float xIm = eIm + oRe * wi + oIm * wr;
+        vReal[k] = sqrtf(xRe * xRe + xIm * xIm);
+#endif
+    }
+}
+
+#if FFT_KERNEL_SELFTEST
+// Runs the reference and the selected kernel on a synthetic grid signal
+// (off-bin fundamental plus 3rd harmonic) and compares all bins up to N/2.
+float RealFft::selfTest() {
+    static uint16_t adcData[ANALYSIS_SIZE];
+    static double refReal[ANALYSIS_SIZE];
+    static double refImag[ANALYSIS_SIZE];
+    static spectrum_t vReal[ANALYSIS_SIZE];
+    static RealFft kernel;
+    arduinoFFT FFT;
+
+    for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) {
+        double t = (double)i / SAMPLING_FREQUENCY;
+        adcData[i] = (uint16_t)lround(2048 + 1500 * sin(TWO_PI * (TARGET_FREQUENCY + 0.137) * t)
+                                           + 120 * sin(TWO_PI * 3 * (TARGET_FREQUENCY + 0.137) * t + 0.5));
+    }
+
+    double avg = 0;
+    for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) avg += adcData[i];
+    avg /= ANALYSIS_SIZE;
+    for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) {
+        refReal[i] = adcData[i] - avg;
+        refImag[i] = 0;
+    }
+    FFT.Windowing(refReal, ANALYSIS_SIZE, FFT_WIN_TYP_HAMMING, FFT_FORWARD);
+    FFT.Compute(refReal, refImag, ANALYSIS_SIZE, FFT_FORWARD);
+    FFT.ComplexToMagnitude(refReal, refImag, ANALYSIS_SIZE);
+
+    kernel.magnitude(adcData, vReal, 1, REAL_FFT_HALF - 1);
+
+    double peak = 0;
+    double maxError = 0;
+    for (uint16_t k = 1; k < REAL_FFT_HALF; k++) {
+        peak = max(peak, refReal[k]);
+        maxError = max(maxError, fabs(vReal[k] - refReal[k]));
+    }
+    return peak > 0 ? (float)(maxError / peak) : 1.0f;
+}
+#endif
@@ -2,75 +2,186 @@
 
 // Public
 
+static_assert((kRingSize & (kRingSize - 1)) == 0, "Ring indexes are masked");
+static_assert((SLICE_SLOTS & (SLICE_SLOTS - 1)) == 0, "Slice slots are indexed by block number");
+static_assert((SLICE_SLOTS - 1) * PHASE_BLOCK_SIZE + ANALYSIS_SIZE <= kRingSize,
+              "A slice slot must not outlive its samples");
+
 FrequencyAnalyzer::FrequencyAnalyzer() {
-    // Create adcDataSliceQueue (slices arrive every ANALYSIS_INTERVAL_MS and
-    // are consumed in loop(), so a few slots of headroom are enough)
-    adcDataSliceQueue = xQueueCreate(4, sizeof(AdcDataSlice));
-    if (adcDataSliceQueue == NULL) {
-        Serial.println("Error creating adcDataSliceQueue! Restarting...");
-        delay(1000);
-        ESP.restart();
+    adcSource = AdcSource::create();
+
+    // Precompute Hann-windowed reference for the single-bin correlation
+    // (symmetric window => phase refers to the block centre, no bias)
+    for (uint16_t n = 0; n < PHASE_BLOCK_SIZE; n++) {
+        double w = 0.5 * (1.0 - cos(TWO_PI * n / (PHASE_BLOCK_SIZE - 1)));
+        double arg = TWO_PI * TARGET_FREQUENCY * n / SAMPLING_FREQUENCY;
+        phaseRefRe[n] = w * cos(arg);
+        phaseRefIm[n] = w * sin(arg);
     }
-}
 
-void FrequencyAnalyzer::beginSampling() {
-    xTaskCreatePinnedToCore(samplerTaskEntry, "sampler", 4096, this, 10, &samplerTaskHandle, 1);
+    // Parseval for a windowed tone: band energy = N * sum(w^2) * (A/2)^2,
+    // while the on-bin peak is sum(w) * A/2
+    double sumW = 0;
+    double sumW2 = 0;
+    for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) {
+        uint16_t j = i < ANALYSIS_SIZE / 2 ? i : ANALYSIS_SIZE - 1 - i;
+        double w = 0.54 - 0.46 * cos(TWO_PI * j / (ANALYSIS_SIZE - 1));
+        sumW += w;
+        sumW2 += w * w;
+    }
+    harmonicEnergyScale = sumW / sqrt(ANALYSIS_SIZE * sumW2);
+    for (uint16_t h = 1; h <= HARMONIC_MAX; h++) {
+        harmonicGain[h] = adcSource->gainAt(h * TARGET_FREQUENCY);
+    }
+
+#if FFT_KERNEL_SELFTEST
+    Serial.printf("FFT kernel %d selftest: max error %.2e of peak\n", FFT_KERNEL, RealFft::selfTest());
+#endif
 }
 
-// ISR context: only an IRAM-safe task notification, nothing else
-void IRAM_ATTR FrequencyAnalyzer::notifySampleFromISR() {
-    if (samplerTaskHandle == nullptr) return;
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    vTaskNotifyGiveFromISR(samplerTaskHandle, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+void FrequencyAnalyzer::beginSampling() {
+    sampleClock.begin();
+    xTaskCreatePinnedToCore(samplerTaskEntry, "sampler", SAMPLER_STACK_SIZE, this, 10, &samplerTaskHandle, 1);
 }
 
 void FrequencyAnalyzer::samplerTaskEntry(void* arg) {
     FrequencyAnalyzer* self = static_cast<FrequencyAnalyzer*>(arg);
+    uint16_t samples[ADC_SOURCE_MAX_SAMPLES];
+
+    // Backend binds to this task (timer ISR target / DMA reader)
+    self->adcSource->begin();
     for (;;) {
-        // Acts as counting semaphore: catches up if samples queued up
-        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
-        self->processSample();
+        size_t count = self->adcSource->read(samples, ADC_SOURCE_MAX_SAMPLES);
+        uint32_t slice = self->sampleCount / PHASE_BLOCK_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            self->processSample(samples[i]);
+        }
+        // Anchor the timebase once per slice, not per read (every sample in
+        // timer mode); SNTP extrapolates over at most a slice from it
+        if (self->sampleCount / PHASE_BLOCK_SIZE != slice) {
+            self->sampleClock.markRead(self->sampleCount);
+        }
     }
 }
 
-void FrequencyAnalyzer::processSample() {
-    ringBuffer[writeIndex] = analogRead(ADC_PIN);
-    if(millis() - lastSliceCopy > ANALYSIS_INTERVAL_MS){
-        // Calculate currentStartIndex
-        lastSliceCopy = millis();
-        uint32_t currentStartIndex = (writeIndex + RING_BUFFER_SIZE - ANALYSIS_SIZE) % RING_BUFFER_SIZE;
+void FrequencyAnalyzer::processSample(uint16_t sample) {
+    const uint32_t mask = kRingSize - 1;
+    uint32_t writeIndex = sampleCount & mask;
+#if SPECTRUM_ENGINE == SPECTRUM_ENGINE_SDFT
+    // The sample leaving the analysis window is still in the ring
+    slidingDft.update(sampleCount, sample, ringBuffer[(sampleCount - ANALYSIS_SIZE) & mask]);
+#endif
+#if SOGI_FLL
+    sogiFll.update(sampleCount, sample);
+#endif
+    ringBuffer[writeIndex] = sample;
+    if (writeIndex < ANALYSIS_SIZE) {
+        // Mirror the head behind the end so every window is contiguous
+        ringBuffer[kRingSize + writeIndex] = sample;
+    }
+    sampleCount++;
 
-        // Generate Data Slice // Set Millis & Timestamp
-        sliceScratch.millis = lastSliceCopy;
-        gettimeofday(&sliceScratch.time, nullptr);
+    // Cut a slice every PHASE_BLOCK_SIZE samples. Block boundaries must be
+    // exactly equidistant for the phase measurement (1 sample = 0.61 rad).
+    // Only the slot header is written; the window stays in the ring.
+    if (sampleCount % PHASE_BLOCK_SIZE == 0) {
+        AdcDataSlice& slot = sliceSlots[(sampleCount / PHASE_BLOCK_SIZE) & (SLICE_SLOTS - 1)];
+        slot.adcData = &ringBuffer[(sampleCount - ANALYSIS_SIZE) & mask];
+        slot.sampleIndex = sampleCount;
+#if SPECTRUM_ENGINE == SPECTRUM_ENGINE_SDFT
+        slidingDft.snapshot(&slot.spectrum);
+#endif
+#if SOGI_FLL
+        sogiFll.snapshot(&slot.fll, true);
+#endif
+    }
 
-        // Copy Data
-        for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) {
-            sliceScratch.adcData[i] = ringBuffer[(currentStartIndex + i) % RING_BUFFER_SIZE];
-        }
+    // Publish: everything written above is visible to the consumer
+    publishedCount.store(sampleCount, std::memory_order_release);
+    if (sampleCount % PHASE_BLOCK_SIZE == 0 && sliceListener != nullptr) {
+        xTaskNotifyGive(sliceListener);
+    }
+}
 
-        // Send Data Slice to Queue (drop slice if queue is full)
-        xQueueSend(adcDataSliceQueue, &sliceScratch, 0);
+// Consumer side of the sample ring: next unread slice, or nullptr. If the
+// consumer fell so far behind that the slot was reused, resume at the newest.
+const AdcDataSlice* FrequencyAnalyzer::acquireSlice() {
+    uint32_t published = publishedCount.load(std::memory_order_acquire);
+    if ((int32_t)(published - nextSliceEnd) < 0) {
+        return nullptr;
+    }
+    if (published - nextSliceEnd >= (SLICE_SLOTS - 1) * PHASE_BLOCK_SIZE) {
+        uint32_t newest = published - published % PHASE_BLOCK_SIZE;
+        uint32_t skipped = (newest - nextSliceEnd) / PHASE_BLOCK_SIZE;
+        droppedSlices += skipped;
+        overrunSlices += skipped;  // Reported from loop(), not from the task that is behind
+        nextSliceEnd = newest;
     }
-    writeIndex = (writeIndex + 1) % RING_BUFFER_SIZE;
+    const AdcDataSlice* slice = &sliceSlots[(nextSliceEnd / PHASE_BLOCK_SIZE) & (SLICE_SLOTS - 1)];
+    nextSliceEnd += PHASE_BLOCK_SIZE;
+    return slice;
+}
+
+// True if neither the slot nor the oldest window sample has been reused
+// while the consumer was reading them
+bool FrequencyAnalyzer::sliceIntact(const AdcDataSlice& slice) {
+    uint32_t published = publishedCount.load(std::memory_order_acquire);
+    return published - slice.sampleIndex < (SLICE_SLOTS - 1) * PHASE_BLOCK_SIZE
+        && published - (slice.sampleIndex - ANALYSIS_SIZE) < kRingSize;
 }
 
 bool FrequencyAnalyzer::getNextSliceAnalysis(FrequencyAnalysis* frequencyAnalysis) {
 
     // Setup
-    static AdcDataSlice adcDataSlice;
+    static spectrum_t vReal[ANALYSIS_SIZE];
+#if SPECTRUM_ENGINE == SPECTRUM_ENGINE_FFT && FFT_KERNEL == FFT_KERNEL_ARDUINO
     static arduinoFFT FFT;
-    static double vReal[ANALYSIS_SIZE];
     static double vImag[ANALYSIS_SIZE];
+#endif
 
-    // Wait up to 1s for new data
-    if (xQueueReceive(adcDataSliceQueue, &adcDataSlice, 0) == pdTRUE) {
-        
-        // Copy Time Data
-        frequencyAnalysis->millis = adcDataSlice.millis;  
-        frequencyAnalysis->time = adcDataSlice.time;   
+    // Next published slice, read in place from the sample ring
+    const AdcDataSlice* slice = acquireSlice();
+    if (slice != nullptr) {
+        const AdcDataSlice& adcDataSlice = *slice;
+#if DISTURBANCE_RECORDER
+        if (recorder) recorder->stageBlock(adcDataSlice.adcData + ANALYSIS_SIZE - PHASE_BLOCK_SIZE);
+#endif
+#if LIVE_SERVER && LIVE_RAW_FRAMES
+        if (rawQueue) {
+            rawFrame.sampleIndex = adcDataSlice.sampleIndex;
+            memcpy(rawFrame.samples, adcDataSlice.adcData + ANALYSIS_SIZE - PHASE_BLOCK_SIZE, sizeof(rawFrame.samples));
+        }
+#endif
+
+        // Time of the newest sample, from the sample clock
+        frequencyAnalysis->millis = sampleClock.toMillis(adcDataSlice.sampleIndex);
+        sampleClock.toTime(adcDataSlice.sampleIndex, &frequencyAnalysis->time);
+        double clockCorrection = sampleClock.rateCorrection();
+        frequencyAnalysis->clockPpm = sampleClock.getPpm();
 
+#if SOGI_FLL
+        frequencyAnalysis->fllFrequency = adcDataSlice.fll.frequencyMean * sampleClock.rateCorrection();
+        frequencyAnalysis->fllPhase = adcDataSlice.fll.phase;
+        frequencyAnalysis->fllLocked = adcDataSlice.fll.locked;
+#endif
+
+        // Search range in bins of the selected spectrum
+        uint16_t firstBin = kSearchFirstBin;
+        uint16_t lastBin = kSearchLastBin;
+
+#if SPECTRUM_ENGINE == SPECTRUM_ENGINE_SDFT
+        // Spectrum was maintained sample by sample, only the search bins exist
+        SlidingDft::toMagnitude(adcDataSlice.spectrum, vReal);
+#elif SPECTRUM_ENGINE == SPECTRUM_ENGINE_ZOOM
+        // Dense band grid; the outermost bins only serve as neighbours
+        zoomDft.compute(adcDataSlice.adcData, vReal);
+        firstBin = 1;
+        lastBin = ZOOM_BINS - 2;
+#elif FFT_KERNEL != FFT_KERNEL_ARDUINO
+        // Real-input float/Q15 FFT, magnitudes only for the search bins and
+        // their interpolation neighbours
+        realFft.magnitude(adcDataSlice.adcData, vReal, firstBin - 1, lastBin + 1);
+#else
         // Calculate average for DC offset removal
         double avg = 0;
         for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) {
@@ -88,41 +199,91 @@ bool FrequencyAnalyzer::getNextSliceAnalysis(FrequencyAnalysis* frequencyAnalysi
         FFT.Windowing(vReal, ANALYSIS_SIZE, FFT_WIN_TYP_HAMMING, FFT_FORWARD);
         FFT.Compute(vReal, vImag, ANALYSIS_SIZE, FFT_FORWARD);
         FFT.ComplexToMagnitude(vReal, vImag, ANALYSIS_SIZE);
+#endif
         
-        // Find peak frequency around power grid frequency (45-55 Hz)
-        double maxAmplitude = 0;
-        uint16_t maxIndex = 0;
-        uint16_t startBin = 45 * ANALYSIS_SIZE / SAMPLING_FREQUENCY;
-        uint16_t endBin = 55 * ANALYSIS_SIZE / SAMPLING_FREQUENCY;
-        
-        for (uint16_t i = startBin; i <= endBin; i++) {
-            if (vReal[i] > maxAmplitude) {
-                maxAmplitude = vReal[i];
-                maxIndex = i;
-            }
-        }
+        // Find peak frequency around power grid frequency
+        double maxAmplitude;
+        uint16_t maxIndex = findPeak(vReal, firstBin, lastBin, &maxAmplitude);
 
         frequencyAnalysis->amplitude = maxAmplitude;
-        frequencyAnalysis->isValidSignal = maxAmplitude > AMPLITUDE_THRESHOLD && maxIndex > 0 && maxIndex < (ANALYSIS_SIZE - 1);
+        frequencyAnalysis->harmonicsValid = false;
+        frequencyAnalysis->isValidSignal = maxAmplitude > SPECTRUM_AMPLITUDE_THRESHOLD && maxIndex > 0 && maxIndex < (ANALYSIS_SIZE - 1);
 
         if (frequencyAnalysis->isValidSignal) {
-            frequencyAnalysis->frequency = interpolateFrequency(vReal, maxIndex, maxAmplitude);
-            double binError = calculateBinError(frequencyAnalysis->frequency - maxIndex);
-            frequencyAnalysis->rawFrequency = frequencyAnalysis->frequency;
-            frequencyAnalysis->frequency += binError;
-            frequencyAvg = frequencyAvg * 0.75 + frequencyAnalysis->frequency * 0.25;
-            frequencyAnalysis->frequency = frequencyAvg;
-            
+            // Coarse: interpolated spectral peak (anchor + amplitude check)
+            double peakBin = interpolatePeak(vReal, maxIndex);
+#if SPECTRUM_ENGINE == SPECTRUM_ENGINE_ZOOM
+            // 0.16 Hz grid: interpolation is accurate without correction
+            frequencyAnalysis->rawFrequency = ZoomDft::binFrequency(peakBin);
+            frequencyAnalysis->coarseFrequency = frequencyAnalysis->rawFrequency;
+#else
+            frequencyAnalysis->rawFrequency = peakBin * (double)SAMPLING_FREQUENCY / ANALYSIS_SIZE;
+            double binError = calculateBinError(peakBin - maxIndex);
+            frequencyAnalysis->coarseFrequency = frequencyAnalysis->rawFrequency + binError;
+#endif
+
+            // Fine: phase rotation between the two newest blocks
+            double fineFrequency = 0;
+            frequencyAnalysis->fineValid = estimateFineFrequency(adcDataSlice, frequencyAnalysis->coarseFrequency, &fineFrequency);
+            frequencyAnalysis->fineFrequency = fineFrequency;
+            frequencyAnalysis->frequency = frequencyAnalysis->fineValid ? frequencyAnalysis->fineFrequency : frequencyAnalysis->coarseFrequency;
+
+#if HARMONIC_ANALYSIS && SPECTRUM_ENGINE == SPECTRUM_ENGINE_FFT
+            analyzeHarmonics(vReal, frequencyAnalysis->frequency, frequencyAnalysis);
+#endif
+
+            // Sample-domain -> real Hz (crystal error, see KONZEPT section 4)
+            frequencyAnalysis->coarseFrequency *= clockCorrection;
+            frequencyAnalysis->fineFrequency *= clockCorrection;
+            frequencyAnalysis->frequency *= clockCorrection;
+
             // Calculate quality metric
             if (maxIndex > 0 && vReal[maxIndex] > 0) {
-                double beta = log(max(1.0, vReal[maxIndex]));
-                double alpha = log(max(1.0, vReal[maxIndex-1]));
-                double gamma = log(max(1.0, vReal[maxIndex+1]));
+                double beta = log(max(1.0, (double)vReal[maxIndex]));
+                double alpha = log(max(1.0, (double)vReal[maxIndex-1]));
+                double gamma = log(max(1.0, (double)vReal[maxIndex+1]));
                 double d2 = (alpha + gamma - 2*beta);
                 frequencyAnalysis->quality = abs(beta) > 1e-6 ? -d2 / (beta * beta) : 0;
             }
+
+#if FREQ_FILTER == FREQ_FILTER_EMA
+            frequencyAvg = frequencyAvg * 0.75 + frequencyAnalysis->frequency * 0.25;
+            frequencyAnalysis->frequency = frequencyAvg;
+#elif FREQ_FILTER == FREQ_FILTER_KALMAN
+            TrackerOutput tracked;
+            double dt = (double)(adcDataSlice.sampleIndex - lastTrackedIndex) / SAMPLING_FREQUENCY;
+            tracker.update(frequencyAnalysis->frequency, frequencyAnalysis->amplitude, frequencyAnalysis->quality,
+                           frequencyAnalysis->fineValid, dt, &tracked);
+            lastTrackedIndex = adcDataSlice.sampleIndex;
+            frequencyAnalysis->frequency = tracked.frequency;
+            frequencyAnalysis->rocof = tracked.rocof;
+            frequencyAnalysis->frequencySigma = tracked.frequencySigma;
+            frequencyAnalysis->rocofSigma = tracked.rocofSigma;
+            frequencyAnalysis->outlier = tracked.outlier;
+#endif
+        } else {
+            // Signal lost: the next block has no valid predecessor
+            hasLastPhase = false;
+            tracker.reset();
+        }
+
+        // Sampler lapped us during the analysis: result is based on torn data
+        if (!sliceIntact(adcDataSlice)) {
+            droppedSlices++;
+            hasLastPhase = false;
+            return false;
         }
 
+#if DISTURBANCE_RECORDER
+        if (recorder) {
+            recorder->commitSlice(adcDataSlice.sampleIndex,
+                                  frequencyAnalysis->isValidSignal ? (float)frequencyAnalysis->frequency : NAN,
+                                  frequencyAnalysis->time);
+        }
+#endif
+#if LIVE_SERVER && LIVE_RAW_FRAMES
+        if (rawQueue && xQueueSend(rawQueue, &rawFrame, 0) != pdPASS) rawDrops++;
+#endif
         return true;
 
     }
@@ -131,10 +292,25 @@ bool FrequencyAnalyzer::getNextSliceAnalysis(FrequencyAnalysis* frequencyAnalysi
 
 }
 
-double FrequencyAnalyzer::interpolateFrequency(double* vReal, uint16_t maxIndex, double maxAmplitude) {
-    double alpha = log(max(1.0, vReal[maxIndex-1]));
-    double beta = log(max(1.0, vReal[maxIndex]));
-    double gamma = log(max(1.0, vReal[maxIndex+1]));
+// Peak bin within startBin..endBin (0 if the range holds no energy)
+uint16_t FrequencyAnalyzer::findPeak(const spectrum_t* vReal, uint16_t startBin, uint16_t endBin, double* maxAmplitude) {
+    uint16_t maxIndex = 0;
+
+    *maxAmplitude = 0;
+    for (uint16_t i = startBin; i <= endBin; i++) {
+        if (vReal[i] > *maxAmplitude) {
+            *maxAmplitude = vReal[i];
+            maxIndex = i;
+        }
+    }
+    return maxIndex;
+}
+
+// Gaussian (log-parabolic) peak interpolation, returns the fractional bin
+double FrequencyAnalyzer::interpolatePeak(const spectrum_t* vReal, uint16_t maxIndex) {
+    double alpha = log(max(1.0, (double)vReal[maxIndex-1]));
+    double beta = log(max(1.0, (double)vReal[maxIndex]));
+    double gamma = log(max(1.0, (double)vReal[maxIndex+1]));
     
     double denom = (alpha - 2*beta + gamma);
     if (abs(denom) > 1e-6) {
@@ -145,15 +321,110 @@ double FrequencyAnalyzer::interpolateFrequency(double* vReal, uint16_t maxIndex,
             p = p / (1 + 0.125 * d2 * p * p);
         }
         
-        return (maxIndex + p) * (double)SAMPLING_FREQUENCY / ANALYSIS_SIZE;
+        return maxIndex + p;
     }
     
-    return maxIndex * (double)SAMPLING_FREQUENCY / ANALYSIS_SIZE;
+    return maxIndex;
 }
 
 double FrequencyAnalyzer::calculateBinError(double p) {
     if (p >= 0) {
-        return -0.06f * (0.5f - fabsf(p - 0.5f));
+        return -kBinErrorScale * (0.5 - fabs(p - 0.5));
+    }
+    return kBinErrorScale * (0.5 - fabs(p + 0.5));
+}
+
+#if HARMONIC_ANALYSIS && SPECTRUM_ENGINE == SPECTRUM_ENGINE_FFT
+// Harmonic amplitudes from the energy of +/-2 bins around h * fundamental.
+// The Hamming main lobe lies within these bins, so the result doesn't
+// depend on where the harmonic falls between bins (no scalloping).
+void FrequencyAnalyzer::analyzeHarmonics(spectrum_t* vReal, double fundamental, FrequencyAnalysis* frequencyAnalysis) {
+    double amplitude[HARMONIC_MAX + 1];
+    for (uint16_t h = 1; h <= HARMONIC_MAX; h++) {
+        long centre = lround(h * fundamental * ANALYSIS_SIZE / SAMPLING_FREQUENCY);
+        if (centre + 2 >= ANALYSIS_SIZE / 2) {
+            amplitude[h] = NAN;
+            continue;
+        }
+#if FFT_KERNEL != FFT_KERNEL_ARDUINO
+        realFft.magnitudeRange(vReal, centre - 2, centre + 2);
+#endif
+        double energy = 0;
+        for (long k = centre - 2; k <= centre + 2; k++) {
+            energy += vReal[k] * vReal[k];
+        }
+        amplitude[h] = sqrt(energy) * harmonicEnergyScale / harmonicGain[h];
+    }
+
+    frequencyAnalysis->harmonicsValid = amplitude[1] > 0;
+    if (!frequencyAnalysis->harmonicsValid) return;
+
+    double distortion = 0;
+    for (uint16_t h = 2; h <= HARMONIC_MAX; h++) {
+        double ratio = amplitude[h] / amplitude[1];
+        frequencyAnalysis->harmonics[h - 2] = 100 * ratio;
+        if (!isnan(ratio)) distortion += ratio * ratio;
+    }
+    frequencyAnalysis->thd = 100 * sqrt(distortion);
+}
+#endif
+
+// Single-bin DFT of one block (DC removed, Hann windowed) at TARGET_FREQUENCY
+bool FrequencyAnalyzer::measurePhase(const uint16_t* block, double* phase) {
+    float avg = 0;
+    for (uint16_t n = 0; n < PHASE_BLOCK_SIZE; n++) {
+        avg += block[n];
+    }
+    avg /= PHASE_BLOCK_SIZE;
+
+    float re = 0;
+    float im = 0;
+    for (uint16_t n = 0; n < PHASE_BLOCK_SIZE; n++) {
+        float x = block[n] - avg;
+        re += x * phaseRefRe[n];
+        im += x * phaseRefIm[n];
+    }
+
+    *phase = atan2(-im, re);
+    return sqrt(re * re + im * im) > PHASE_MAG_THRESHOLD * ADC_SAMPLE_SCALE;
+}
+
+bool FrequencyAnalyzer::estimateFineFrequency(const AdcDataSlice& slice, double coarseFrequency, double* fineFrequency) {
+    const double blockPeriod = (double)PHASE_BLOCK_SIZE / SAMPLING_FREQUENCY;  // 0.25 s
+
+    // Newest block = last PHASE_BLOCK_SIZE samples of the slice
+    double phase;
+    bool magValid = measurePhase(&slice.adcData[ANALYSIS_SIZE - PHASE_BLOCK_SIZE], &phase);
+
+    // Previous phase only usable if the blocks are direct neighbours
+    // (a dropped slice or signal loss breaks the phase reference)
+    bool consecutive = hasLastPhase && slice.sampleIndex - lastPhaseIndex == PHASE_BLOCK_SIZE;
+    double previousPhase = lastPhase;
+    hasLastPhase = magValid;
+    lastPhase = phase;
+    lastPhaseIndex = slice.sampleIndex;
+    if (!magValid || !consecutive) {
+        return false;
+    }
+
+    // Deviation from the nominal rotation, wrapped to (-pi, +pi]
+    double dphi = phase - previousPhase - kPhaseStepNominal;
+    dphi -= TWO_PI * ceil((dphi - PI) / TWO_PI);
+    double fine = TARGET_FREQUENCY + dphi / (TWO_PI * blockPeriod);
+
+    // Unambiguous only within +/- 1/(2*blockPeriod): unwrap in steps of
+    // 1/blockPeriod (4 Hz) using the FFT estimate as anchor
+    fine += round((coarseFrequency - fine) * blockPeriod) / blockPeriod;
+
+    // Plausibility: a lost sample shows up as a ~0.39 Hz jump
+    if (fabs(fine - coarseFrequency) > PHASE_MAX_DEVIATION) {
+        return false;
     }
-    return 0.06f * (0.5f - fabsf(p + 0.5f));
-}
\ No newline at end of file
+
+    *fineFrequency = fine;
+    return true;
+}
+
+bool FrequencyAnalyzer::getAcquisitionLoad(AcquisitionLoad* load) {
+    return adcSource->getLoad(load);
+}
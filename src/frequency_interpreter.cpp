@@ -2,8 +2,11 @@
 
 FrequencyInterpreter::FrequencyInterpreter(){}
 
-FrequencyAlert FrequencyInterpreter::interpret(const FrequencyAnalysis& analysis) {
-    FrequencyAlert alert = {false, false, "none", analysis, 0, 0, "none", 0};
+FrequencyAlert FrequencyInterpreter::interpret(const FrequencyAnalysis& analysis, AlarmEvent* events, uint8_t* eventCount) {
+    FrequencyAlert alert = {false, false, ALARM_NONE, analysis, 0, 0, {}, 0};
+    for (uint8_t w = 0; w < ROCOF_WINDOWS; w++) {
+        alert.rocof[w] = NAN;
+    }
 
     // Warmup period to stabilize measurements
     if(warmup) {
@@ -12,52 +15,43 @@ FrequencyAlert FrequencyInterpreter::interpret(const FrequencyAnalysis& analysis
         alert.valid = true;
     }
 
-    // Check for amplitude error (signal quality)
+    // Amplitude error (signal quality): restart warmup and RoCoF windows
     if (!analysis.isValidSignal) {
         warmup = 40;
-        alert.hasAlert = true;
-        alert.alertType = "AMPL";
-        snprintf(alert.message, LCD_COLS, "AMPL: %.0f", alert.frequencyAnalysis.amplitude);
-        return alert;
+        rocofEngine.reset();
+    } else {
+        updateMetrics(analysis, &alert);
     }
 
-    // Calculate frequency metrics
-    alert.deviation = fabsf(analysis.frequency - TARGET_FREQUENCY);
-    alert.analyzingDelay = alert.frequencyAnalysis.millis - lastRun;
-    alert.ramp = ((float)fabsf(analysis.frequency - lastFreq) / (float)alert.analyzingDelay) * 1000 * 4;
-    lastRun = alert.frequencyAnalysis.millis;
+    // Alarm rules run on every slice, events only on state changes
+    *eventCount = alarmEngine.update(alert, events);
+    alert.alertType = alarmEngine.mostSevere();
+    alert.hasAlert = alert.alertType != ALARM_NONE;
+    return alert;
+}
+
+void FrequencyInterpreter::updateMetrics(const FrequencyAnalysis& analysis, FrequencyAlert* alert) {
+    alert->deviation = fabsf(analysis.frequency - TARGET_FREQUENCY);
+    alert->analyzingDelay = analysis.millis - lastRun;
+#if FREQ_FILTER == FREQ_FILTER_KALMAN
+    // The tracker estimates RoCoF as a state; outliers never reach it
+    alert->ramp = analysis.rocof;
+#else
+    // Plain difference quotient. Adjacent fine estimates share a block (each
+    // is the phase step between two), so their errors are anti-correlated:
+    // the quotient is noisier than for independent measurements, not
+    // smoother. Alarms only use the windowed RoCoF below.
+    alert->ramp = ((float)(analysis.frequency - lastFreq) / (float)alert->analyzingDelay) * 1000;
+#endif
+    lastRun = analysis.millis;
     lastFreq = analysis.frequency;
 
-    // Rate of Change (RoCoF) check - highest priority
-    if (alert.ramp >= ROCOF_THRESHOLD && alert.ramp < 10) {
-        alert.hasAlert = true;
-        alert.alertType = "ROCOF";
-        snprintf(alert.message, LCD_COLS, "RoCoF: %.3f Hz/s", alert.ramp);
-        return alert;
+    // Windowed RoCoF from the unfiltered per-slice estimate; smoothing before
+    // the regression would flatten the slopes. Rejected outliers are replaced
+    // by the tracker's value.
+    double raw = analysis.fineValid ? analysis.fineFrequency : analysis.coarseFrequency;
+    rocofEngine.update(analysis.outlier ? analysis.frequency : raw, analysis.millis);
+    for (uint8_t w = 0; w < ROCOF_WINDOWS; w++) {
+        alert->rocof[w] = rocofEngine.getRocof(w);
     }
-
-    // Frequency deviation checks - staged alerts, most severe first
-    // (otherwise the mildest threshold always matches and returns early)
-    if (alert.deviation >= LEVEL2_EMERGENCY_THRESHOLD) {
-        alert.hasAlert = true;
-        alert.alertType = "LEVEL2_EMERGENCY_THRESHOLD";
-        snprintf(alert.message, LCD_COLS, "EMERG2: %.3f Hz", alert.frequencyAnalysis.frequency);
-        return alert;
-    }
-
-    if (alert.deviation >= LEVEL1_EMERGENCY_THRESHOLD) {
-        alert.hasAlert = true;
-        alert.alertType = "LEVEL1_EMERGENCY_THRESHOLD";
-        snprintf(alert.message, LCD_COLS, "EMERG1: %.3f Hz", alert.frequencyAnalysis.frequency);
-        return alert;
-    }
-
-    if (alert.deviation >= ALERT_RANGE_THRESHOLD) {
-        alert.hasAlert = true;
-        alert.alertType = "ALERT_RANGE_THRESHOLD";
-        snprintf(alert.message, LCD_COLS, "ALERT: %.3f Hz", alert.frequencyAnalysis.frequency);
-        return alert;
-    }
-
-    return alert;
-}
\ No newline at end of file
+}
@@ -0,0 +1,93 @@
+#include "frequency_tracker.h"
+#include <algorithm>
+#include "adc_source.h"
+
+void FrequencyTracker::update(double measurement, double amplitude, double quality, bool fine, double dt, TrackerOutput* out) {
+    double variance = measurementVariance(amplitude, quality, fine);
+    bool hampelFlag = hampelOutlier(measurement, sqrt(variance));
+
+    out->outlier = false;
+    if (!initialised) {
+        initialise(measurement, variance);
+    } else {
+        // Predict
+        f += r * dt;
+        double q = KALMAN_ROCOF_NOISE;
+        double n00 = p00 + 2 * dt * p01 + dt * dt * p11 + q * dt * dt * dt / 3;
+        double n01 = p01 + dt * p11 + q * dt * dt / 2;
+        double n11 = p11 + q * dt;
+        p00 = n00;
+        p01 = n01;
+        p11 = n11;
+
+        // Gate on the normalised innovation
+        double innovation = measurement - f;
+        double s = p00 + variance;
+        if (innovation * innovation > KALMAN_GATE * KALMAN_GATE * s) {
+            if (hampelFlag) {
+                out->outlier = true;
+            } else {
+                // Consistent with the recent measurements: a real step
+                initialise(measurement, variance);
+            }
+        } else {
+            double k0 = p00 / s;
+            double k1 = p01 / s;
+            f += k0 * innovation;
+            r += k1 * innovation;
+            n00 = (1 - k0) * p00;
+            n01 = (1 - k0) * p01;
+            n11 = p11 - k1 * p01;
+            p00 = n00;
+            p01 = n01;
+            p11 = n11;
+        }
+    }
+
+    out->frequency = f;
+    out->rocof = r;
+    out->frequencySigma = sqrt(p00);
+    out->rocofSigma = sqrt(p11);
+}
+
+// sigma = base * amplitude factor * quality factor (* coarse factor), each
+// factor >= 1 so a strong, sharp peak gives the base noise
+double FrequencyTracker::measurementVariance(double amplitude, double quality, bool fine) {
+    double sigma = KALMAN_FINE_NOISE_HZ;
+    double referenceAmplitude = KALMAN_REF_AMPLITUDE * ADC_SAMPLE_SCALE;
+    if (amplitude > 0 && amplitude < referenceAmplitude) sigma *= referenceAmplitude / amplitude;
+    if (quality > KALMAN_REF_QUALITY) sigma *= quality / KALMAN_REF_QUALITY;
+    if (!fine) sigma *= KALMAN_COARSE_FACTOR;
+    return sigma * sigma;
+}
+
+// Hampel identifier over the last HAMPEL_WINDOW raw measurements (including
+// this one). The MAD is floored at the measurement noise, otherwise a quiet
+// grid would flag every slice.
+bool FrequencyTracker::hampelOutlier(double measurement, double sigma) {
+    hampel[hampelNext] = measurement;
+    hampelNext = (hampelNext + 1) % HAMPEL_WINDOW;
+    if (hampelCount < HAMPEL_WINDOW) hampelCount++;
+    if (hampelCount < HAMPEL_WINDOW) return true;  // Too few to tell a step from a spike
+
+    double sorted[HAMPEL_WINDOW];
+    double deviation[HAMPEL_WINDOW];
+    memcpy(sorted, hampel, sizeof(sorted));
+    std::sort(sorted, sorted + HAMPEL_WINDOW);
+    double median = sorted[HAMPEL_WINDOW / 2];
+    for (uint8_t i = 0; i < HAMPEL_WINDOW; i++) {
+        deviation[i] = fabs(hampel[i] - median);
+    }
+    std::sort(deviation, deviation + HAMPEL_WINDOW);
+    double scale = max(1.4826 * deviation[HAMPEL_WINDOW / 2], sigma);
+    return fabs(measurement - median) > HAMPEL_THRESHOLD * scale;
+}
+
+void FrequencyTracker::initialise(double measurement, double variance) {
+    f = measurement;
+    r = 0;
+    p00 = variance;
+    p01 = 0;
+    p11 = KALMAN_INITIAL_ROCOF * KALMAN_INITIAL_ROCOF;
+    initialised = true;
+}
@@ -1,45 +1,358 @@
 #include "frequency_transmitter.h"
 
-FrequencyTransmitter::FrequencyTransmitter(PubSubClient& client)
-    : mqttClient(client) {
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BATCH
+static_assert(BATCH_SIZE > 0 && BATCH_SIZE < 256, "Batch count is one byte");
+static_assert(PAYLOAD_BATCH_HEADER + BATCH_SIZE * PAYLOAD_BATCH_SAMPLE_MAX + 128 <= MQTT_MAX_PACKET_SIZE, "Batch exceeds the MQTT packet size");
+#endif
+#if DISTURBANCE_RECORDER
+static_assert(RECORDER_CHUNK_RECORDS * RECORDER_DAT_RECORD + 128 <= MQTT_MAX_PACKET_SIZE, "Capture chunk exceeds the MQTT packet size");
+#endif
+#if REPORT_MODE == REPORT_MODE_CHANGE
+static_assert(PAYLOAD_FORMAT != PAYLOAD_FORMAT_BATCH, "Batches need results on a fixed interval");
+#endif
+#if MEASUREMENT_JOURNAL
+static_assert(JOURNAL_BACKFILL_RECORDS * PAYLOAD_BINARY_SIZE + 128 <= MQTT_MAX_PACKET_SIZE, "Backfill chunk exceeds the MQTT packet size");
+#endif
+
+FrequencyTransmitter::FrequencyTransmitter(Networking& network)
+    : network(network) {
+}
+
+void FrequencyTransmitter::begin() {
+#if MEASUREMENT_JOURNAL
+    journal.begin();
+#endif
+}
+
+// RSSI comes from the network task, the only user of WiFi
+static SystemMetrics readSystemMetrics(Networking& network) {
+    SystemMetrics metrics;
+    metrics.freeHeap = ESP.getFreeHeap();
+    metrics.cpuFreq = ESP.getCpuFreqMHz();
+    metrics.rssi = network.getRssi();
+    metrics.heapUsage = 100.0f * (1.0f - (float)metrics.freeHeap / (float)ESP.getHeapSize());
+    return metrics;
 }
 
 void FrequencyTransmitter::transmit(const FrequencyAlert& alert) {
-    char message[800];  // Increased buffer size for additional metrics
-    
+#if LIVE_SERVER
+    // LAN clients get every result, whatever the broker side reports
+    if (liveServer && liveServer->hasClients()) {
+        char message[880];
+        size_t len = formatJson(alert, readSystemMetrics(network), message, sizeof(message));
+        liveServer->broadcast(message, len);
+    }
+#endif
+#if REPORT_MODE == REPORT_MODE_CHANGE
+    FrequencyAlert reports[2];
+    uint8_t count = reportFilter.update(alert, reports);
+    for (uint8_t i = 0; i < count; i++) {
+        publishMeasurement(reports[i]);
+    }
+#else
+    publishMeasurement(alert);
+#endif
+}
+
+void FrequencyTransmitter::publishMeasurement(const FrequencyAlert& alert) {
+
     // Get system metrics
-    uint32_t freeHeap = ESP.getFreeHeap();
-    uint8_t cpuFreq = ESP.getCpuFreqMHz();
-    int8_t rssi = WiFi.RSSI();
-    float heapUsagePercent = 100.0f * (1.0f - (float)freeHeap / (float)ESP.getHeapSize());
-    
+    SystemMetrics metrics = readSystemMetrics(network);
+    bool connected = network.isConnected();
+
+#if MEASUREMENT_JOURNAL
+    // Offline: kept in flash for the backfill instead of being lost
+    if (!connected) {
+        journalMeasurement(alert, metrics);
+        return;
+    }
+#endif
+
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BATCH
+    // An active alarm sends at once, so alert latency stays one slice
+    batchMetrics = metrics;
+    if (!batch.add(alert)) {
+        flushBatch();
+        batch.add(alert);
+    }
+    if (alert.hasAlert || batch.full()) flushBatch();
+    return;
+#endif
+
+    if (!connected) {
+        Serial.println("Skipped publish (not connected).");
+        return;
+    }
+
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BINARY
+    uint8_t payload[PAYLOAD_BINARY_SIZE];
+    size_t len = encodeMeasurement(alert, metrics, payload, sizeof(payload));
+    bool sent = network.publish(MQTT_TOPIC "/bin", payload, len, NET_PRIORITY_LIVE);
+#else
+    bool sent = transmitJson(alert, metrics);
+#endif
+    if (!sent) {
+#if MEASUREMENT_JOURNAL
+        // Outbound queue full: journaled rather than dropped
+        journalMeasurement(alert, metrics);
+#else
+        Serial.println("Skipped publish (queue full).");
+#endif
+    }
+}
+
+#if MEASUREMENT_JOURNAL
+void FrequencyTransmitter::journalMeasurement(const FrequencyAlert& alert, const SystemMetrics& metrics) {
+    uint8_t record[PAYLOAD_BINARY_SIZE];
+    encodeMeasurement(alert, metrics, record, sizeof(record));
+    journal.append(record);
+}
+
+// Journal replay: version 1 records back to back on MQTT_TOPIC "/backfill",
+// oldest first, at most one message per JOURNAL_BACKFILL_MS so live data
+// keeps the link. A chunk the outbound queue rejects is retried on the next call.
+void FrequencyTransmitter::transmitBackfill() {
+    if (!network.isConnected()) {
+        return;
+    }
+
+    if (millis() - lastJournalStatus >= JOURNAL_STATUS_MS) {
+        char oldest[24] = "null";
+        int64_t oldestTime = journal.oldestTime();
+        if (oldestTime) snprintf(oldest, sizeof(oldest), "%lld", (long long)oldestTime);
+        char message[200];
+        snprintf(message, sizeof(message),
+                 "{\"sensorId\":\"%s\",\"depth\":%lu,\"oldest\":%s,\"pages\":%lu,\"capacity\":%lu,\"lost\":%lu}",
+                 SENSOR_ID, (unsigned long)journal.depth(), oldest, (unsigned long)journal.flashPages(),
+                 (unsigned long)JOURNAL_CAPACITY, (unsigned long)journal.getLost());
+        if (network.publish(MQTT_TOPIC "/journal", message, NET_PRIORITY_LIVE)) lastJournalStatus = millis();
+    }
+
+    if (millis() - lastBackfill < JOURNAL_BACKFILL_MS) {
+        return;
+    }
+    uint8_t chunk[JOURNAL_BACKFILL_RECORDS * PAYLOAD_BINARY_SIZE];
+    uint16_t count = journal.peek(chunk, JOURNAL_BACKFILL_RECORDS);
+    if (!count) return;
+    lastBackfill = millis();
+    if (network.publish(MQTT_TOPIC "/backfill", chunk, count * PAYLOAD_BINARY_SIZE, NET_PRIORITY_BULK)) {
+        journal.consume(count);
+    }
+}
+#endif
+
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BATCH
+void FrequencyTransmitter::flushBatch() {
+    if (!batch.count()) return;
+    uint8_t payload[PAYLOAD_BATCH_HEADER + BATCH_SIZE * PAYLOAD_BATCH_SAMPLE_MAX];
+    size_t len = batch.finish(batchMetrics, payload, sizeof(payload));
+    if (!network.isConnected() || !network.publish(MQTT_TOPIC "/batch", payload, len, NET_PRIORITY_LIVE)) {
+        Serial.println("Skipped batch publish (not connected or queue full).");
+    }
+    batch.reset();
+}
+
+void FrequencyTransmitter::flushIfDue() {
+    if (batch.count() && millis() - batch.firstMillis() >= BATCH_MAX_LATENCY_MS) {
+        flushBatch();
+    }
+}
+#endif
+
+bool FrequencyTransmitter::transmitJson(const FrequencyAlert& alert, const SystemMetrics& metrics) {
+    char message[880];  // Increased buffer size for additional metrics
+    formatJson(alert, metrics, message, sizeof(message));
+    return network.publish(MQTT_TOPIC, message, NET_PRIORITY_LIVE);
+}
+
+size_t FrequencyTransmitter::formatJson(const FrequencyAlert& alert, const SystemMetrics& metrics, char* message, size_t size) {
     // Get timestamp with microsecond precision
     struct timeval tv = alert.frequencyAnalysis.time;
     uint64_t timestamp_ms = ((uint64_t)tv.tv_sec * 1000) + (tv.tv_usec / 1000); // Convert to milliseconds
+
+    // Harmonics 2..HARMONIC_MAX in % of the fundamental, null where not measured.
+    // Values that do not fit are cut off; the list is closed in any case.
+    char power[16 + 10 * HARMONIC_MAX];
+    const FrequencyAnalysis& analysis = alert.frequencyAnalysis;
+    if (analysis.harmonicsValid) {
+        int len = snprintf(power, sizeof(power), "%.2f,\"harm\":[", analysis.thd);
+        for (uint16_t h = 0; h < HARMONIC_MAX - 1 && len < (int)sizeof(power) - 1; h++) {
+            int n = snprintf(power + len, sizeof(power) - 1 - len, isfinite(analysis.harmonics[h]) ? "%s%.2f" : "%snull",
+                             h ? "," : "", analysis.harmonics[h]);
+            if (n >= (int)sizeof(power) - 1 - len) break;
+            len += n;
+        }
+        if (len > (int)sizeof(power) - 2) len = sizeof(power) - 2;
+        snprintf(power + len, sizeof(power) - len, "]");
+    } else {
+        snprintf(power, sizeof(power), "null,\"harm\":null");
+    }
+
+    // Windowed RoCoF, null until a window is filled
+    char rocof[8 + 12 * ROCOF_WINDOWS];
+    int rocofLen = snprintf(rocof, sizeof(rocof), "[");
+    for (uint8_t w = 0; w < ROCOF_WINDOWS; w++) {
+        rocofLen += snprintf(rocof + rocofLen, sizeof(rocof) - rocofLen, isnan(alert.rocof[w]) ? "%snull" : "%s%.4f",
+                             w ? "," : "", alert.rocof[w]);
+    }
+    snprintf(rocof + rocofLen, sizeof(rocof) - rocofLen, "]");
     
-    snprintf(message, sizeof(message),
-             "{\"sensorId\":\"%s\",\"time\":%llu,\"freq\":%.3f,\"amp\":%.1f,\"quality\":%.3f,\"alert\":%s,"
-             "\"alertType\":\"%s\",\"deviation\":%.3f,\"ramp\":%.9f,\"analyzingDelay\":%i,"
-             "\"freeHeap\":%u,\"heapUsage\":%.1f,\"cpuFreq\":%u,\"wifiRSSI\":%d}",
+    int len = snprintf(message, size,
+             "{\"sensorId\":\"%s\",\"time\":%llu,\"freq\":%.3f,\"freqCoarse\":%.3f,\"freqFll\":%.3f,\"amp\":%.1f,\"quality\":%.3f,\"thd\":%s,\"alert\":%s,"
+             "\"alertType\":\"%s\",\"deviation\":%.3f,\"ramp\":%.9f,\"rocof\":%s,\"rocofStd\":%.4f,\"analyzingDelay\":%i,"
+             "\"clockPpm\":%.2f,\"freeHeap\":%u,\"heapUsage\":%.1f,\"cpuFreq\":%u,\"wifiRSSI\":%d}",
              SENSOR_ID,
              timestamp_ms,
              alert.frequencyAnalysis.frequency,
+             alert.frequencyAnalysis.coarseFrequency,
+             alert.frequencyAnalysis.fllFrequency,
              alert.frequencyAnalysis.amplitude,
              alert.frequencyAnalysis.quality,
+             power,
              alert.hasAlert ? "true" : "false",
-             alert.alertType,
+             alarmName(alert.alertType),
              alert.deviation,
              alert.ramp,
+             rocof,
+             alert.frequencyAnalysis.rocofSigma,
              alert.analyzingDelay,
-             freeHeap,
-             heapUsagePercent,
-             cpuFreq,
-             rssi
+             alert.frequencyAnalysis.clockPpm,
+             metrics.freeHeap,
+             metrics.heapUsage,
+             metrics.cpuFreq,
+             metrics.rssi
             );
-             
-    if (WiFi.status() == WL_CONNECTED && mqttClient.connected()) {
-        mqttClient.publish(MQTT_TOPIC, message);
-    } else {
-        Serial.println("Skipped publish (not connected).");
+    return len < (int)size ? len : size - 1;
+}
+
+// Event records to MQTT_TOPIC "/events"; start is the UNIX time in ms
+void FrequencyTransmitter::transmitEvent(const AlarmEvent& event) {
+    char message[200];
+    uint64_t start_ms = ((uint64_t)event.start.tv_sec * 1000) + (event.start.tv_usec / 1000);
+    snprintf(message, sizeof(message),
+             "{\"sensorId\":\"%s\",\"type\":\"%s\",\"phase\":\"%s\",\"start\":%llu,\"duration\":%lu,\"value\":%.4f,\"peak\":%.4f}",
+             SENSOR_ID,
+             alarmName(event.type),
+             alarmPhaseName(event.phase),
+             start_ms,
+             (unsigned long)event.durationMs,
+             event.value,
+             event.peak);
+
+    // Queued through an outage, as far as the queue holds them
+    if (!network.publish(MQTT_TOPIC "/events", message, NET_PRIORITY_EVENT)) {
+        Serial.println("Skipped event publish (queue full).");
+    }
+}
+
+// Appends ",<name>:<value>" (or the list of values), null for empty intervals
+static int appendValues(char* out, size_t size, const char* name, const float* values, uint8_t count, bool list) {
+    int len = snprintf(out, size, list ? ",\"%s\":[" : ",\"%s\":", name);
+    for (uint8_t i = 0; i < count && len < (int)size; i++) {
+        len += snprintf(out + len, size - len, isfinite(values[i]) ? "%s%.4f" : "%snull", i ? "," : "", values[i]);
+    }
+    if (list && len < (int)size) len += snprintf(out + len, size - len, "]");
+    return len;
+}
+
+// Closed statistics interval to MQTT_TOPIC "/stats"; band times in s
+void FrequencyTransmitter::transmitStats(const StatsSummary& summary) {
+    static const float quantiles[STATS_QUANTILE_COUNT] = STATS_QUANTILES;
+    char message[600];
+    int len = snprintf(message, sizeof(message), "{\"sensorId\":\"%s\",\"start\":%llu,\"interval\":%u,\"count\":%lu,\"invalid\":%lu",
+                       SENSOR_ID, (uint64_t)summary.start * 1000, summary.interval,
+                       (unsigned long)summary.count, (unsigned long)summary.invalid);
+    len += appendValues(message + len, sizeof(message) - len, "p", quantiles, STATS_QUANTILE_COUNT, true);
+    len += appendValues(message + len, sizeof(message) - len, "freqMin", &summary.freqMin, 1, false);
+    len += appendValues(message + len, sizeof(message) - len, "freqMax", &summary.freqMax, 1, false);
+    len += appendValues(message + len, sizeof(message) - len, "freqMean", &summary.freqMean, 1, false);
+    len += appendValues(message + len, sizeof(message) - len, "freqStd", &summary.freqStd, 1, false);
+    len += appendValues(message + len, sizeof(message) - len, "freqQ", summary.freqQuantile, STATS_QUANTILE_COUNT, true);
+    len += appendValues(message + len, sizeof(message) - len, "devMax", &summary.devMax, 1, false);
+    len += appendValues(message + len, sizeof(message) - len, "devMean", &summary.devMean, 1, false);
+    len += appendValues(message + len, sizeof(message) - len, "devStd", &summary.devStd, 1, false);
+    len += appendValues(message + len, sizeof(message) - len, "devQ", summary.devQuantile, STATS_QUANTILE_COUNT, true);
+    float bands[STATS_BANDS];
+    for (uint8_t b = 0; b < STATS_BANDS; b++) {
+        bands[b] = summary.bandSlices[b] * (float)PHASE_BLOCK_SIZE / SAMPLING_FREQUENCY;
     }
-}
\ No newline at end of file
+    len += appendValues(message + len, sizeof(message) - len, "bands", bands, STATS_BANDS, true);
+    if (len >= (int)sizeof(message) - 1) {
+        Serial.println("Stats message truncated.");
+        return;
+    }
+    snprintf(message + len, sizeof(message) - len, "}");
+
+    if (!network.publish(MQTT_TOPIC "/stats", message, NET_PRIORITY_LIVE)) {
+        Serial.println("Skipped stats publish (queue full).");
+    }
+}
+
+bool FrequencyTransmitter::transmitMemoryBudget() {
+    if (!network.isConnected()) {
+        return false;
+    }
+    char message[400];
+    int len = snprintf(message, sizeof(message), "{\"sensorId\":\"%s\",\"budget\":", SENSOR_ID);
+    len += formatMemoryBudget(message + len, sizeof(message) - len - 1);
+    snprintf(message + len, sizeof(message) - len, "}");
+    return network.publish(MQTT_TOPIC "/memory", message, NET_PRIORITY_LIVE);
+}
+
+// Outbound queue use and losses to MQTT_TOPIC "/net"; rejected per class
+// (bulk rejections are retried by their producer, not lost)
+void FrequencyTransmitter::transmitNetworkStats() {
+    NetworkStats stats = network.getStats();
+    char message[260];
+    snprintf(message, sizeof(message),
+             "{\"sensorId\":\"%s\",\"queued\":%lu,\"peak\":%lu,\"capacity\":%d,\"sent\":%lu,\"failed\":%lu,"
+             "\"rejected\":{\"bulk\":%lu,\"live\":%lu,\"event\":%lu},\"reconnects\":%lu}",
+             SENSOR_ID, (unsigned long)stats.queued, (unsigned long)stats.peak, NET_QUEUE_BYTES,
+             (unsigned long)stats.sent, (unsigned long)stats.failed,
+             (unsigned long)stats.rejected[NET_PRIORITY_BULK], (unsigned long)stats.rejected[NET_PRIORITY_LIVE],
+             (unsigned long)stats.rejected[NET_PRIORITY_EVENT], (unsigned long)stats.reconnects);
+    if (network.isConnected()) network.publish(MQTT_TOPIC "/net", message, NET_PRIORITY_LIVE);
+}
+
+#if DISTURBANCE_RECORDER
+// COMTRADE export, one message per call: <id>/cfg, <id>/dat/<first record>
+// (binary records), then <id>/end. The id is the trigger time in UNIX s.
+// A chunk the outbound queue rejects is retried on the next call.
+void FrequencyTransmitter::transmitCapture(DisturbanceRecorder& recorder) {
+    if (!network.isConnected()) {
+        return;
+    }
+    const DisturbanceCapture& capture = recorder.capture();
+    unsigned long id = capture.trigger.tv_sec;
+    char topic[128];
+
+    if (!captureCfgSent) {
+        char cfg[400];
+        snprintf(topic, sizeof(topic), "%s/capture/%lu/cfg", MQTT_TOPIC, id);
+        size_t len = recorder.formatCfg(cfg, sizeof(cfg));
+        captureCfgSent = network.publish(topic, (const uint8_t*)cfg, len, NET_PRIORITY_BULK);
+        return;
+    }
+
+    if (captureRecord < recorder.records()) {
+        uint8_t chunk[RECORDER_CHUNK_RECORDS * RECORDER_DAT_RECORD];
+        snprintf(topic, sizeof(topic), "%s/capture/%lu/dat/%lu", MQTT_TOPIC, id, (unsigned long)captureRecord);
+        size_t len = recorder.formatDat(chunk, captureRecord, RECORDER_CHUNK_RECORDS);
+        if (network.publish(topic, chunk, len, NET_PRIORITY_BULK)) {
+            captureRecord += len / RECORDER_DAT_RECORD;
+        }
+        return;
+    }
+
+    char message[160];
+    snprintf(topic, sizeof(topic), "%s/capture/%lu/end", MQTT_TOPIC, id);
+    snprintf(message, sizeof(message), "{\"sensorId\":\"%s\",\"type\":\"%s\",\"records\":%lu,\"recordBytes\":%d,\"dropped\":%lu}",
+             SENSOR_ID, alarmName(capture.type), (unsigned long)recorder.records(), RECORDER_DAT_RECORD,
+             (unsigned long)recorder.getDropped());
+    if (network.publish(topic, message, NET_PRIORITY_BULK)) {
+        captureCfgSent = false;
+        captureRecord = 0;
+        recorder.release();
+    }
+}
+#endif
@@ -0,0 +1,380 @@
+#include "live_server.h"
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define WS_TEXT 0x1
+#define WS_BINARY 0x2
+#define WS_CLOSE 0x8
+#define WS_PING 0x9
+#define WS_PONG 0xA
+#define WS_PROTOCOL_ERROR 1002
+
+static const char kIndexPage[] =
+    "<!DOCTYPE html><html><head><meta charset=\"utf-8\"><title>" SENSOR_ID "</title></head>"
+    "<body style=\"font-family:sans-serif\"><h1 id=\"f\">--</h1><pre id=\"m\"></pre><script>"
+    "var w=new WebSocket('ws://'+location.host+'/ws');"
+    "w.onmessage=function(e){var m=JSON.parse(e.data);"
+    "document.getElementById('f').textContent=m.freq.toFixed(3)+' Hz';"
+    "document.getElementById('m').textContent=JSON.stringify(m,null,1);};"
+    "</script></body></html>";
+
+// SHA-1 (FIPS 180-1), only for the handshake: short input, one call
+static uint32_t rol(uint32_t v, uint8_t n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+static void sha1Block(uint32_t* h, const uint8_t* p) {
+    uint32_t w[80];
+    for (uint8_t i = 0; i < 16; i++) {
+        w[i] = (uint32_t)p[4 * i] << 24 | (uint32_t)p[4 * i + 1] << 16 | (uint32_t)p[4 * i + 2] << 8 | p[4 * i + 3];
+    }
+    for (uint8_t i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (uint8_t i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+        uint32_t t = rol(a, 5) + f + e + k + w[i];
+        e = d; d = c; c = rol(b, 30); b = a; a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+static void sha1(const uint8_t* data, size_t length, uint8_t* digest) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    size_t full = length & ~(size_t)63;
+    for (size_t i = 0; i < full; i += 64) sha1Block(h, data + i);
+
+    // Tail, 0x80, zeros, 64-bit bit length: one or two blocks
+    uint8_t tail[128] = {0};
+    size_t rest = length - full;
+    memcpy(tail, data + full, rest);
+    tail[rest] = 0x80;
+    size_t blocks = rest < 56 ? 64 : 128;
+    uint64_t bits = (uint64_t)length * 8;
+    for (uint8_t b = 0; b < 8; b++) tail[blocks - 1 - b] = bits >> (8 * b);
+    for (size_t i = 0; i < blocks; i += 64) sha1Block(h, tail + i);
+    for (uint8_t i = 0; i < 20; i++) digest[i] = h[i / 4] >> (24 - 8 * (i % 4));
+}
+
+static size_t base64(const uint8_t* data, size_t length, char* out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char* p = out;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16 | (i + 1 < length ? data[i + 1] << 8 : 0) | (i + 2 < length ? data[i + 2] : 0);
+        *p++ = alphabet[(v >> 18) & 0x3F];
+        *p++ = alphabet[(v >> 12) & 0x3F];
+        *p++ = i + 1 < length ? alphabet[(v >> 6) & 0x3F] : '=';
+        *p++ = i + 2 < length ? alphabet[v & 0x3F] : '=';
+    }
+    *p = '\0';
+    return p - out;
+}
+
+// Value of a request header (case-insensitive name), false if absent
+static bool headerValue(const char* headers, const char* name, char* out, size_t size) {
+    size_t nameLength = strlen(name);
+    for (const char* line = headers; line && *line; line = strstr(line, "\r\n")) {
+        if (line[0] == '\r') line += 2;
+        if (strncasecmp(line, name, nameLength) != 0 || line[nameLength] != ':') continue;
+        const char* v = line + nameLength + 1;
+        while (*v == ' ') v++;
+        size_t n = 0;
+        while (v[n] && v[n] != '\r' && n + 1 < size) n++;
+        memcpy(out, v, n);
+        out[n] = '\0';
+        return true;
+    }
+    return false;
+}
+
+LiveServer::LiveServer(LiveStatusFormatter statusFormatter)
+    : statusFormatter(statusFormatter) {
+    for (uint8_t i = 0; i < LIVE_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].state = LIVE_CLIENT_FREE;
+    }
+}
+
+bool LiveServer::begin(uint16_t port) {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(listenFd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(listenFd, LIVE_MAX_CLIENTS) < 0) {
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+void LiveServer::poll(unsigned long nowMs) {
+    if (listenFd < 0) return;
+    accept(nowMs);
+    for (uint8_t i = 0; i < LIVE_MAX_CLIENTS; i++) {
+        LiveClient& c = clients[i];
+        if (c.state == LIVE_CLIENT_FREE) continue;
+        receive(c);
+        if (c.state == LIVE_CLIENT_HTTP) handleRequest(c);
+        if (c.state == LIVE_CLIENT_WEBSOCKET) handleFrames(c);
+        if (c.state != LIVE_CLIENT_FREE && c.rxLength == LIVE_RX_BUFFER) close(c);  // Request larger than the buffer
+        if (c.state != LIVE_CLIENT_FREE) send(c, nowMs);
+    }
+    countClients();
+}
+
+void LiveServer::accept(unsigned long nowMs) {
+    for (;;) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;
+        LiveClient* c = nullptr;
+        for (uint8_t i = 0; i < LIVE_MAX_CLIENTS && !c; i++) {
+            if (clients[i].state == LIVE_CLIENT_FREE) c = &clients[i];
+        }
+        if (!c) {
+            static const char busy[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            ::send(fd, busy, sizeof(busy) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+            ::close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        c->fd = fd;
+        c->state = LIVE_CLIENT_HTTP;
+        c->raw = false;
+        c->rxLength = 0;
+        c->txLength = 0;
+        c->drops = 0;
+        c->lastProgress = nowMs;
+    }
+}
+
+void LiveServer::close(LiveClient& c) {
+    ::close(c.fd);
+    c.fd = -1;
+    c.state = LIVE_CLIENT_FREE;
+}
+
+void LiveServer::receive(LiveClient& c) {
+    if (c.rxLength == LIVE_RX_BUFFER) return;
+    ssize_t n = recv(c.fd, c.rx + c.rxLength, LIVE_RX_BUFFER - c.rxLength, MSG_DONTWAIT);
+    if (n > 0) {
+        c.rxLength += n;
+        if (c.state == LIVE_CLIENT_CLOSING) c.rxLength = 0;
+    } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        close(c);
+    }
+}
+
+void LiveServer::send(LiveClient& c, unsigned long nowMs) {
+    if (c.txLength) {
+        ssize_t n = ::send(c.fd, c.tx, c.txLength, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            memmove(c.tx, c.tx + n, c.txLength - n);
+            c.txLength -= n;
+            c.lastProgress = nowMs;
+        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            close(c);
+            return;
+        }
+    }
+    if (c.txLength == 0 && c.state != LIVE_CLIENT_HTTP) {
+        if (c.state == LIVE_CLIENT_CLOSING) {
+            close(c);
+            return;
+        }
+        c.lastProgress = nowMs;
+    }
+    // Stalled reader, or a request that never completes
+    if (nowMs - c.lastProgress > LIVE_STALL_MS) close(c);
+}
+
+bool LiveServer::queue(LiveClient& c, const void* data, size_t length) {
+    if (c.txLength + length > LIVE_CLIENT_BUFFER) return false;
+    memcpy(c.tx + c.txLength, data, length);
+    c.txLength += length;
+    return true;
+}
+
+// Server frames are unmasked; payloads up to 64 KB
+bool LiveServer::queueFrame(LiveClient& c, uint8_t opcode, const void* payload, size_t length) {
+    uint8_t header[4] = {(uint8_t)(0x80 | opcode)};
+    size_t headerLength = 2;
+    if (length < 126) {
+        header[1] = length;
+    } else if (length < 65536) {
+        header[1] = 126;
+        header[2] = length >> 8;
+        header[3] = length & 0xFF;
+        headerLength = 4;
+    } else {
+        return false;
+    }
+    if (c.txLength + headerLength + length > LIVE_CLIENT_BUFFER) return false;
+    queue(c, header, headerLength);
+    queue(c, payload, length);
+    return true;
+}
+
+void LiveServer::respond(LiveClient& c, const char* status, const char* type, const char* body, size_t length) {
+    char header[192];
+    int n = snprintf(header, sizeof(header),
+                     "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n"
+                     "Cache-Control: no-store\r\nAccess-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n",
+                     status, type, (unsigned)length);
+    c.state = LIVE_CLIENT_CLOSING;
+    if (!queue(c, header, n) || !queue(c, body, length)) close(c);
+}
+
+void LiveServer::handleRequest(LiveClient& c) {
+    // Complete header block
+    char* end = nullptr;
+    for (uint16_t i = 3; i < c.rxLength && !end; i++) {
+        if (memcmp(c.rx + i - 3, "\r\n\r\n", 4) == 0) end = (char*)c.rx + i + 1;
+    }
+    if (!end) return;
+    end[-2] = '\0';
+    char* request = (char*)c.rx;
+    uint16_t consumed = (uint8_t*)end - c.rx;
+
+    char path[32] = "";
+    if (strncmp(request, "GET ", 4) == 0) {
+        size_t n = strcspn(request + 4, " \r");
+        if (n < sizeof(path)) {
+            memcpy(path, request + 4, n);
+            path[n] = '\0';
+        }
+    }
+    const char* headers = strstr(request, "\r\n");
+
+    if (strcmp(path, "/") == 0) {
+        respond(c, "200 OK", "text/html", kIndexPage, sizeof(kIndexPage) - 1);
+    } else if (strcmp(path, "/status") == 0) {
+        size_t length = statusFormatter ? statusFormatter(status, sizeof(status)) : 0;
+        if (length) respond(c, "200 OK", "application/json", status, length);
+        else respond(c, "500 Internal Server Error", "text/plain", "", 0);
+    } else if (strcmp(path, "/ws") == 0 || strcmp(path, "/ws?raw=1") == 0) {
+        char upgrade[16], key[32];
+        if (!headers || !headerValue(headers, "Upgrade", upgrade, sizeof(upgrade)) || strcasecmp(upgrade, "websocket") != 0
+            || !headerValue(headers, "Sec-WebSocket-Key", key, sizeof(key))) {
+            respond(c, "400 Bad Request", "text/plain", "", 0);
+        } else {
+            uint8_t input[sizeof(key) + sizeof(WS_GUID)], digest[20];
+            char accept[32], response[160];
+            size_t keyLength = strlen(key);
+            memcpy(input, key, keyLength);
+            memcpy(input + keyLength, WS_GUID, sizeof(WS_GUID) - 1);
+            sha1(input, keyLength + sizeof(WS_GUID) - 1, digest);
+            base64(digest, sizeof(digest), accept);
+            int n = snprintf(response, sizeof(response),
+                             "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                             "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+            queue(c, response, n);
+            c.state = LIVE_CLIENT_WEBSOCKET;
+            c.raw = path[3] == '?';
+        }
+    } else {
+        respond(c, "404 Not Found", "text/plain", "", 0);
+    }
+
+    // Anything after the headers is the first WebSocket frame
+    memmove(c.rx, c.rx + consumed, c.rxLength - consumed);
+    c.rxLength -= consumed;
+}
+
+// Client frames: answer ping and close, ignore the rest. A client must mask
+// every frame (RFC 6455 5.1); an unmasked one closes with a protocol error.
+void LiveServer::handleFrames(LiveClient& c) {
+    while (c.rxLength >= 2 && c.state == LIVE_CLIENT_WEBSOCKET) {
+        uint8_t opcode = c.rx[0] & 0x0F;
+        if (!(c.rx[1] & 0x80)) {
+            const uint8_t code[2] = {WS_PROTOCOL_ERROR >> 8, WS_PROTOCOL_ERROR & 0xFF};
+            queueFrame(c, WS_CLOSE, code, sizeof(code));
+            c.state = LIVE_CLIENT_CLOSING;
+            c.rxLength = 0;
+            return;
+        }
+        size_t length = c.rx[1] & 0x7F;
+        size_t headerLength = 2;
+        if (length == 126) {
+            if (c.rxLength < 4) return;
+            length = (size_t)c.rx[2] << 8 | c.rx[3];
+            headerLength = 4;
+        } else if (length == 127) {
+            close(c);
+            return;
+        }
+        uint8_t* mask = c.rx + headerLength;
+        headerLength += 4;
+        if (headerLength + length > LIVE_RX_BUFFER) {
+            close(c);
+            return;
+        }
+        if (c.rxLength < headerLength + length) return;
+
+        uint8_t* payload = c.rx + headerLength;
+        for (size_t i = 0; i < length; i++) payload[i] ^= mask[i & 3];
+        if (opcode == WS_CLOSE) {
+            queueFrame(c, WS_CLOSE, payload, length < 2 ? length : 2);
+            c.state = LIVE_CLIENT_CLOSING;
+        } else if (opcode == WS_PING) {
+            queueFrame(c, WS_PONG, payload, length);
+        }
+        memmove(c.rx, c.rx + headerLength + length, c.rxLength - headerLength - length);
+        c.rxLength -= headerLength + length;
+    }
+}
+
+void LiveServer::broadcast(const char* text, size_t length) {
+    for (uint8_t i = 0; i < LIVE_MAX_CLIENTS; i++) {
+        LiveClient& c = clients[i];
+        if (c.state != LIVE_CLIENT_WEBSOCKET) continue;
+        if (!queueFrame(c, WS_TEXT, text, length)) {
+            c.drops++;
+            drops++;
+        }
+    }
+}
+
+void LiveServer::broadcastRaw(const uint8_t* data, size_t length) {
+    for (uint8_t i = 0; i < LIVE_MAX_CLIENTS; i++) {
+        LiveClient& c = clients[i];
+        if (c.state != LIVE_CLIENT_WEBSOCKET || !c.raw) continue;
+        if (!queueFrame(c, WS_BINARY, data, length)) {
+            c.drops++;
+            drops++;
+        }
+    }
+}
+
+void LiveServer::countClients() {
+    webSockets = 0;
+    rawClients = 0;
+    for (uint8_t i = 0; i < LIVE_MAX_CLIENTS; i++) {
+        if (clients[i].state != LIVE_CLIENT_WEBSOCKET) continue;
+        webSockets++;
+        if (clients[i].raw) rawClients++;
+    }
+}
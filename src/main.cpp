@@ -2,36 +2,126 @@
 #include <esp_task_wdt.h>
 
 // Global variables initialization
-hw_timer_t *timer = NULL;
 Networking *networking = nullptr;
 FrequencyAnalyzer *analyzer = nullptr;
 FrequencyInterpreter *interpreter = nullptr;
 FrequencyTransmitter *transmitter = nullptr;
 DisplayHandler *display = nullptr;
 
-// ISR must stay minimal: analogRead() & friends are not ISR-safe (flash
-// resident, take locks) and crash/hang when WiFi does flash writes.
-// The actual sampling happens in the analyzer's high-priority task.
-void IRAM_ATTR onTimer(){
-    analyzer->notifySampleFromISR();
-}
+// Analysis task output. Display only needs the newest result (overwrite),
+// the transmitter gets every result and display and MQTT every alarm event
+// until their queue is full.
+static TaskHandle_t analysisTaskHandle = nullptr;
+static QueueHandle_t analysisQueue = nullptr;
+static QueueHandle_t transmitQueue = nullptr;
+static QueueHandle_t alarmQueue = nullptr;
+#if DISTURBANCE_RECORDER
+static DisturbanceRecorder* recorder = nullptr;
+#endif
+#if STREAM_STATS
+static StreamStats* streamStats = nullptr;
+static QueueHandle_t statsQueue = nullptr;
+#endif
+#if LIVE_SERVER
+static LiveServer* liveServer = nullptr;
+static QueueHandle_t rawQueue = nullptr;
+static FrequencyAnalysis latestAnalysis{};
+#endif
+static volatile uint32_t transmitDrops = 0;
+static volatile uint32_t alarmDrops = 0;
+#if STREAM_STATS
+static volatile uint32_t statsDrops = 0;
+#endif
 
-void setup_timer(){
+// A lost end would leave the event open on the LCD and on MQTT
+static_assert(ALARM_QUEUE_LENGTH >= 2 * ALARM_TYPES, "Alarm queue must hold a start and an end of every alarm type");
 
-    // Configure timer for stable 512Hz sampling with larger prescaler
-    uint32_t apb_freq = getApbFrequency();
-    uint32_t prescaler = 2;
-    uint32_t timer_divider = apb_freq / (prescaler * SAMPLING_FREQUENCY);
+// Slice analysis and interpretation, woken by the sampler for every slice.
+// Never blocks on display or network: full queues drop the newest item,
+// counted per queue and reported from loop().
+static void analysisTaskEntry(void* arg) {
+    esp_task_wdt_add(NULL);
+    uint8_t rawCount = 0;
+    for (;;) {
+        esp_task_wdt_reset();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
 
-    timer = timerBegin(0, prescaler, true);
-    timerAttachInterrupt(timer, &onTimer, true);
-    timerAlarmWrite(timer, timer_divider, true);
-    timerAlarmEnable(timer);
+        FrequencyAnalysis frequencyAnalysis{};
+        AlarmEvent events[ALARM_TYPES];
+        uint8_t eventCount;
+        while (analyzer->getNextSliceAnalysis(&frequencyAnalysis)) {
+            FrequencyAlert alert = interpreter->interpret(frequencyAnalysis, events, &eventCount);
+            xQueueOverwrite(analysisQueue, &frequencyAnalysis);
+            for (uint8_t i = 0; i < eventCount; i++) {
+                if (xQueueSend(alarmQueue, &events[i], 0) != pdPASS) alarmDrops++;
+#if DISTURBANCE_RECORDER
+                if (events[i].phase == ALARM_EVENT_START) recorder->trigger(events[i]);
+#endif
+            }
+#if STREAM_STATS
+            StatsSummary closed[STATS_INTERVAL_COUNT];
+            uint8_t closedCount = streamStats->update(frequencyAnalysis, closed);
+            for (uint8_t i = 0; i < closedCount; i++) {
+                if (xQueueSend(statsQueue, &closed[i], 0) != pdPASS) statsDrops++;
+            }
+#endif
+            // Raw stream at reduced rate; slices with an active alarm always go out
+            if (alert.valid && (alert.hasAlert || ++rawCount >= RAW_PUBLISH_DIVIDER)) {
+                rawCount = 0;
+                if (xQueueSend(transmitQueue, &alert, 0) != pdPASS) transmitDrops++;
+            }
+            frequencyAnalysis = FrequencyAnalysis{};
+        }
+    }
+}
 
-    Serial.printf("APB Freq: %lu Hz, Timer Divider: %lu, Actual sampling rate: %.2f Hz\n",
-                  apb_freq, timer_divider, (float)apb_freq / (prescaler * timer_divider));
+// Queues are created once at boot; the device cannot run without one
+static QueueHandle_t createQueue(const char* name, UBaseType_t length, UBaseType_t itemSize) {
+    QueueHandle_t queue = xQueueCreate(length, itemSize);
+    if (queue == NULL) {
+        Serial.printf("Error creating %s! Restarting...\n", name);
+        delay(1000);
+        ESP.restart();
+    }
+    return queue;
+}
+
+// Prints the increase of a drop counter since the last report
+static void reportDrops(const char* format, uint32_t count, uint32_t* reported) {
+    if (count == *reported) return;
+    Serial.printf(format, (unsigned long)(count - *reported));
+    *reported = count;
+}
 
+#if LIVE_SERVER
+// /status body: newest analysis, alarm history and connection state
+static size_t formatLiveStatus(char* out, size_t size) {
+    const FrequencyAnalysis& a = latestAnalysis;
+    uint64_t time_ms = (uint64_t)a.time.tv_sec * 1000 + a.time.tv_usec / 1000;
+    int len = snprintf(out, size,
+                       "{\"sensorId\":\"%s\",\"uptime\":%lu,\"analysis\":{\"time\":%llu,\"freq\":%.4f,\"amp\":%.1f,"
+                       "\"quality\":%.3f,\"valid\":%s,\"clockPpm\":%.2f},\"alarms\":[",
+                       SENSOR_ID, millis() / 1000, time_ms, a.frequency, a.amplitude, a.quality,
+                       a.isValidSignal ? "true" : "false", a.clockPpm);
+    uint16_t alarms = min<uint16_t>(display->getAlarmCount(), LIVE_STATUS_ALARMS);
+    for (uint16_t n = 0; n < alarms && len < (int)size; n++) {
+        const AlarmRecord& record = display->getAlarm(n);
+        len += snprintf(out + len, size - len, "%s{\"time\":%llu,\"type\":\"%s\",\"message\":\"%.*s\"}",
+                        n ? "," : "", (uint64_t)record.time * 1000, alarmName(record.type),
+                        (int)strnlen(record.message, LCD_COLS), record.message);
+    }
+    NetworkStats net = networking->getStats();
+    if (len < (int)size) {
+        len += snprintf(out + len, size - len,
+                        "],\"network\":{\"wifi\":%s,\"mqtt\":%s,\"queued\":%lu,\"sent\":%lu,\"reconnects\":%lu},"
+                        "\"droppedSlices\":%lu,\"liveDrops\":%lu}",
+                        networking->isWifiConnected() ? "true" : "false", networking->isConnected() ? "true" : "false",
+                        (unsigned long)net.queued, (unsigned long)net.sent, (unsigned long)net.reconnects,
+                        (unsigned long)analyzer->getDroppedSlices(), (unsigned long)liveServer->getDrops());
+    }
+    return len < (int)size ? len : 0;
 }
+#endif
 
 void setup(){
 
@@ -56,12 +146,49 @@ void setup(){
     // Initialize frequency analysis components
     analyzer = new FrequencyAnalyzer();
     interpreter = new FrequencyInterpreter();
-    transmitter = new FrequencyTransmitter(networking->getMqttClient());
+    transmitter = new FrequencyTransmitter(*networking);
+    transmitter->begin();
 
-    // Start sampling task, then the timer that triggers it
-    pinMode(ADC_PIN,INPUT);
+#if LIVE_SERVER
+    // LAN server; the analysis task hands raw frames over without blocking
+    if (WIFI_CONFIGURED) {
+        liveServer = new LiveServer(formatLiveStatus);
+        if (liveServer->begin(LIVE_SERVER_PORT)) {
+            transmitter->setLiveServer(liveServer);
+#if LIVE_RAW_FRAMES
+            rawQueue = createQueue("rawQueue", LIVE_RAW_QUEUE_LENGTH, sizeof(RawFrame));
+            analyzer->setRawQueue(rawQueue);
+#endif
+        } else {
+            Serial.println("Live server failed to start.");
+        }
+    }
+#endif
+
+#if DISTURBANCE_RECORDER
+    recorder = new DisturbanceRecorder();
+    analyzer->setRecorder(recorder);
+#endif
+
+    // Analysis task and its output queues
+    analysisQueue = createQueue("analysisQueue", 1, sizeof(FrequencyAnalysis));
+    transmitQueue = createQueue("transmitQueue", TRANSMIT_QUEUE_LENGTH, sizeof(FrequencyAlert));
+    alarmQueue = createQueue("alarmQueue", ALARM_QUEUE_LENGTH, sizeof(AlarmEvent));
+#if STREAM_STATS
+    streamStats = new StreamStats();
+    statsQueue = createQueue("statsQueue", STATS_QUEUE_LENGTH, sizeof(StatsSummary));
+#endif
+    if (xTaskCreatePinnedToCore(analysisTaskEntry, "analysis", ANALYSIS_TASK_STACK, nullptr, ANALYSIS_TASK_PRIORITY, &analysisTaskHandle, ANALYSIS_TASK_CORE) != pdPASS) {
+        Serial.println("Error creating analysis task! Restarting...");
+        delay(1000);
+        ESP.restart();
+    }
+    analyzer->setSliceListener(analysisTaskHandle);
+
+    // Start sampling task (starts the timer or DMA acquisition itself)
     analyzer->beginSampling();
-    setup_timer();
+
+    printMemoryBudget();
 
 }
 
@@ -70,20 +197,13 @@ void loop(){
       // Feed the watchdog
       esp_task_wdt_reset();
 
-      // Analyze Data
-      FrequencyAnalysis frequencyAnalysis{0};
-      if(analyzer->getNextSliceAnalysis(&frequencyAnalysis)){
-        FrequencyAlert alert = interpreter->interpret(frequencyAnalysis);
+      // Newest analysis for the display
+      FrequencyAnalysis frequencyAnalysis;
+      if (xQueueReceive(analysisQueue, &frequencyAnalysis, 0) == pdPASS) {
         display->updateAnalysis(frequencyAnalysis);
-        if(alert.valid){
-
-            // Update display and handle alerts
-            if (alert.hasAlert) display->addAlert(alert);
-
-            // Transmit the results via MQTT
-            transmitter->transmit(alert);
-
-        }
+#if LIVE_SERVER
+        latestAnalysis = frequencyAnalysis;
+#endif
 
         // Debug information
         Serial.print("Freq: ");
@@ -92,15 +212,100 @@ void loop(){
         Serial.print(frequencyAnalysis.amplitude);
         Serial.print(", Quality: ");
         Serial.println(frequencyAnalysis.quality, 3);
-      };
-      
-      // Networking Data
+      }
+
+      // Alarm events and results queued by the analysis task
+      AlarmEvent event;
+      while (xQueueReceive(alarmQueue, &event, 0) == pdPASS) {
+        display->addEvent(event);
+        transmitter->transmitEvent(event);
+      }
+      FrequencyAlert alert;
+      while (xQueueReceive(transmitQueue, &alert, 0) == pdPASS) {
+        transmitter->transmit(alert);
+      }
+#if STREAM_STATS
+      StatsSummary summary;
+      while (xQueueReceive(statsQueue, &summary, 0) == pdPASS) {
+        transmitter->transmitStats(summary);
+      }
+#endif
+
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BATCH
+      transmitter->flushIfDue();
+#endif
+
+#if MEASUREMENT_JOURNAL
+      // Measurements journaled while offline, only once the live queue is empty
+      if (uxQueueMessagesWaiting(transmitQueue) == 0) transmitter->transmitBackfill();
+#endif
+
+#if DISTURBANCE_RECORDER
+      // Frozen capture, one chunk per pass so the loop stays responsive
+      if (recorder->hasCapture()) transmitter->transmitCapture(*recorder);
+#endif
+
+#if LIVE_SERVER
+      // LAN clients: raw frames, then accept, answer and send without blocking
+      if (liveServer) {
+#if LIVE_RAW_FRAMES
+          RawFrame raw;
+          while (rawQueue && xQueueReceive(rawQueue, &raw, 0) == pdPASS) {
+              if (!liveServer->hasRawClients()) continue;
+              uint8_t payload[PAYLOAD_RAW_SIZE];
+              liveServer->broadcastRaw(payload, encodeRawFrame(raw, payload, sizeof(payload)));
+          }
+#endif
+          liveServer->poll(millis());
+      }
+#endif
+
+      // Output of the analysis task lost while loop() was blocked, one
+      // counter per queue it feeds (the display's newest result is overwritten)
+      static uint32_t reportedTransmitDrops = 0, reportedAlarmDrops = 0;
+      reportDrops("Transmit queue full: %lu results dropped\n", transmitDrops, &reportedTransmitDrops);
+      reportDrops("Alarm queue full: %lu events dropped\n", alarmDrops, &reportedAlarmDrops);
+#if STREAM_STATS
+      static uint32_t reportedStatsDrops = 0;
+      reportDrops("Stats queue full: %lu summaries dropped\n", statsDrops, &reportedStatsDrops);
+#endif
+#if LIVE_SERVER && LIVE_RAW_FRAMES
+      static uint32_t reportedRawDrops = 0;
+      reportDrops("Raw queue full: %lu frames dropped\n", analyzer->getRawDrops(), &reportedRawDrops);
+#endif
+
+      // Slices the analysis task skipped because it fell behind the sampler
+      static uint32_t reportedOverruns = 0;
+      reportDrops("Analysis overrun: skipped %lu slices\n", analyzer->getOverrunSlices(), &reportedOverruns);
+
+      // Static memory budget, once per boot as soon as MQTT is up
+      static bool budgetSent = false;
+      if (!budgetSent) budgetSent = transmitter->transmitMemoryBudget();
+
+      // Decimation chain cost vs. its budget (oversampled acquisition only)
+      static unsigned long lastLoadReport = 0;
+      AcquisitionLoad load;
+      if (millis() - lastLoadReport > DECIMATOR_REPORT_MS && analyzer->getAcquisitionLoad(&load)) {
+          lastLoadReport = millis();
+          Serial.printf("Decimator: last %lu, peak %lu of %lu cycles (%.0f%% of budget), %lu overruns\n",
+                        load.lastCycles, load.peakCycles, load.budgetCycles,
+                        100.0f * load.peakCycles / load.budgetCycles, load.overruns);
+      }
+
+      // Outbound queue depth and losses
+      static unsigned long lastNetReport = 0;
+      if (millis() - lastNetReport > NET_REPORT_MS) {
+          lastNetReport = millis();
+          transmitter->transmitNetworkStats();
+      }
+
+      // Connection status for the display (WiFi/MQTT run in their own task)
       networking->loop();
 
       // Display Loop
       display->loop();
 
       // Add small delay to prevent task hogging CPU
-      vTaskDelay(pdMS_TO_TICKS(10)); 
+      vTaskDelay(pdMS_TO_TICKS(10));
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,174 @@
+#include "measurement_journal.h"
+#include <LittleFS.h>
+
+#define JOURNAL_MAGIC 0x314E4A46   // "FJN1"
+#define JOURNAL_POSITION JOURNAL_DIR "/pos"
+
+// Saved when a page is written or fully sent
+struct JournalPosition {
+    uint32_t magic;
+    uint32_t writeSeq;
+    uint32_t readSeq;
+    uint16_t readRecord;
+    uint16_t reserved;
+};
+
+static void slotPath(char* out, size_t size, uint32_t seq) {
+    snprintf(out, size, JOURNAL_DIR "/%03lu", (unsigned long)(seq % JOURNAL_PAGES));
+}
+
+bool MeasurementJournal::begin() {
+    mounted = LittleFS.begin(true);
+    if (!mounted) {
+        Serial.println("Journal: LittleFS mount failed, offline measurements are lost.");
+        return false;
+    }
+    if (!LittleFS.exists(JOURNAL_DIR)) LittleFS.mkdir(JOURNAL_DIR);
+
+    JournalPosition pos;
+    File f = LittleFS.open(JOURNAL_POSITION, FILE_READ);
+    if (f && f.read((uint8_t*)&pos, sizeof(pos)) == sizeof(pos) && pos.magic == JOURNAL_MAGIC) {
+        writeSeq = pos.writeSeq;
+        readSeq = pos.readSeq;
+        readRecord = pos.readRecord;
+    }
+    if (f) f.close();
+
+    // Pages written after the last position save, then pages since overwritten
+    JournalPageHeader header;
+    for (uint32_t i = 0; i < JOURNAL_PAGES && readSlot(writeSeq, &header); i++) writeSeq++;
+    if (writeSeq - readSeq > JOURNAL_PAGES) {
+        readSeq = writeSeq - JOURNAL_PAGES;
+        readRecord = 0;
+    }
+    while (readSeq != writeSeq && !readSlot(readSeq, &header)) {
+        readSeq++;
+        readRecord = 0;
+    }
+    Serial.printf("Journal: %lu unsent records in %lu pages\n", (unsigned long)depth(), (unsigned long)flashPages());
+    return true;
+}
+
+bool MeasurementJournal::readSlot(uint32_t seq, JournalPageHeader* header) {
+    char path[24];
+    slotPath(path, sizeof(path), seq);
+    if (!LittleFS.exists(path)) return false;
+    File f = LittleFS.open(path, FILE_READ);
+    if (!f) return false;
+    bool ok = f.read((uint8_t*)header, sizeof(*header)) == sizeof(*header);
+    f.close();
+    return ok && header->magic == JOURNAL_MAGIC && header->seq == seq
+        && header->records == JOURNAL_PAGE_RECORDS && header->recordSize == PAYLOAD_BINARY_SIZE;
+}
+
+void MeasurementJournal::savePosition() {
+    JournalPosition pos{JOURNAL_MAGIC, writeSeq, readSeq, readRecord, 0};
+    File f = LittleFS.open(JOURNAL_POSITION, FILE_WRITE);
+    if (!f) return;
+    f.write((const uint8_t*)&pos, sizeof(pos));
+    f.close();
+}
+
+void MeasurementJournal::append(const uint8_t* record) {
+    memcpy(page + JOURNAL_PAGE_HEADER + pageRecords * PAYLOAD_BINARY_SIZE, record, PAYLOAD_BINARY_SIZE);
+    if (++pageRecords == JOURNAL_PAGE_RECORDS) writePage();
+}
+
+// One full page per flash write
+void MeasurementJournal::writePage() {
+    JournalPageHeader header{JOURNAL_MAGIC, writeSeq, pageRecords, PAYLOAD_BINARY_SIZE, 0};
+    memcpy(page, &header, sizeof(header));
+
+    // Ring full: the oldest page gives way
+    if (writeSeq - readSeq >= JOURNAL_PAGES) {
+        lost += JOURNAL_PAGE_RECORDS - readRecord;
+        readSeq++;
+        readRecord = 0;
+    }
+
+    bool ok = false;
+    if (mounted) {
+        char path[24];
+        slotPath(path, sizeof(path), writeSeq);
+        File f = LittleFS.open(path, FILE_WRITE);
+        if (f) {
+            ok = f.write(page, JOURNAL_PAGE_SIZE) == JOURNAL_PAGE_SIZE;
+            f.close();
+        }
+    }
+    if (ok) {
+        if (readSeq == writeSeq) readRecord = pageRead;   // Was being sent from RAM
+        writeSeq++;
+        savePosition();
+    } else {
+        lost += pageRecords - pageRead;
+        if (mounted) Serial.println("Journal: page write failed.");
+    }
+    pageRecords = 0;
+    pageRead = 0;
+}
+
+// Records from one page at a time: flash pages first, then the RAM page
+uint16_t MeasurementJournal::peek(uint8_t* out, uint16_t maxRecords) {
+    if (readSeq != writeSeq) {
+        uint16_t count = min<uint16_t>(maxRecords, JOURNAL_PAGE_RECORDS - readRecord);
+        char path[24];
+        slotPath(path, sizeof(path), readSeq);
+        File f = LittleFS.open(path, FILE_READ);
+        bool ok = f && f.seek(JOURNAL_PAGE_HEADER + readRecord * PAYLOAD_BINARY_SIZE)
+                    && f.read(out, count * PAYLOAD_BINARY_SIZE) == count * PAYLOAD_BINARY_SIZE;
+        if (f) f.close();
+        if (ok) return count;
+
+        // Unreadable page: skip it
+        lost += JOURNAL_PAGE_RECORDS - readRecord;
+        readSeq++;
+        readRecord = 0;
+        savePosition();
+        return 0;
+    }
+    uint16_t count = min<uint16_t>(maxRecords, pageRecords - pageRead);
+    memcpy(out, page + JOURNAL_PAGE_HEADER + pageRead * PAYLOAD_BINARY_SIZE, count * PAYLOAD_BINARY_SIZE);
+    return count;
+}
+
+void MeasurementJournal::consume(uint16_t records) {
+    if (readSeq != writeSeq) {
+        readRecord += records;
+        if (readRecord >= JOURNAL_PAGE_RECORDS) {
+            readSeq++;
+            readRecord = 0;
+            savePosition();
+        }
+        return;
+    }
+    pageRead += records;
+    if (pageRead >= pageRecords) {
+        pageRecords = 0;
+        pageRead = 0;
+    }
+}
+
+uint32_t MeasurementJournal::depth() {
+    return (writeSeq - readSeq) * JOURNAL_PAGE_RECORDS - readRecord + pageRecords - pageRead;
+}
+
+// Record time: little-endian i64 at offset 4
+int64_t MeasurementJournal::oldestTime() {
+    uint8_t time[8];
+    if (readSeq != writeSeq) {
+        char path[24];
+        slotPath(path, sizeof(path), readSeq);
+        File f = LittleFS.open(path, FILE_READ);
+        bool ok = f && f.seek(JOURNAL_PAGE_HEADER + readRecord * PAYLOAD_BINARY_SIZE + 4) && f.read(time, 8) == 8;
+        if (f) f.close();
+        if (!ok) return 0;
+    } else if (pageRead < pageRecords) {
+        memcpy(time, page + JOURNAL_PAGE_HEADER + pageRead * PAYLOAD_BINARY_SIZE + 4, 8);
+    } else {
+        return 0;
+    }
+    uint64_t value = 0;
+    for (uint8_t b = 0; b < 8; b++) value |= (uint64_t)time[b] << (8 * b);
+    return (int64_t)value;
+}
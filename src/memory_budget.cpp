@@ -0,0 +1,61 @@
+#include "memory_budget.h"
+#include "main.h"
+
+#if SPECTRUM_ENGINE == SPECTRUM_ENGINE_FFT && FFT_KERNEL == FFT_KERNEL_ARDUINO
+#define SPECTRUM_SCRATCH_ARRAYS 2  // vReal + vImag
+#else
+#define SPECTRUM_SCRATCH_ARRAYS 1
+#endif
+
+const MemoryBudgetEntry memoryBudget[] = {
+    {"analyzer", sizeof(FrequencyAnalyzer)},
+    {"analyzer.ring", (kRingSize + ANALYSIS_SIZE) * sizeof(uint16_t)},
+    {"spectrum", SPECTRUM_SCRATCH_ARRAYS * ANALYSIS_SIZE * sizeof(spectrum_t)},
+    {"interpreter", sizeof(FrequencyInterpreter)},
+    {"display", sizeof(DisplayHandler)},
+    {"display.alarms", MAX_ALARMS * sizeof(AlarmRecord)},
+    {"networking", sizeof(Networking)},
+    {"networking.queue", NET_QUEUE_BYTES},
+#if DISTURBANCE_RECORDER
+    {"recorder", sizeof(DisturbanceRecorder)},
+#endif
+#if LIVE_SERVER
+    {"live", sizeof(LiveServer) + (LIVE_RAW_FRAMES ? LIVE_RAW_QUEUE_LENGTH * sizeof(RawFrame) : 0)},
+#endif
+#if MEASUREMENT_JOURNAL
+    {"journal", sizeof(MeasurementJournal)},
+#endif
+#if STREAM_STATS
+    {"stats", sizeof(StreamStats) + STATS_QUEUE_LENGTH * sizeof(StatsSummary)},
+#endif
+    {"queues", sizeof(FrequencyAnalysis) + TRANSMIT_QUEUE_LENGTH * sizeof(FrequencyAlert) + ALARM_QUEUE_LENGTH * sizeof(AlarmEvent)},
+    {"stacks", SAMPLER_STACK_SIZE + ANALYSIS_TASK_STACK + NET_TASK_STACK},
+};
+const uint8_t memoryBudgetEntries = sizeof(memoryBudget) / sizeof(memoryBudget[0]);
+
+uint32_t memoryBudgetTotal() {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < memoryBudgetEntries; i++) {
+        if (strchr(memoryBudget[i].module, '.') == nullptr) total += memoryBudget[i].bytes;
+    }
+    return total;
+}
+
+void printMemoryBudget() {
+    Serial.printf("Memory budget (%s layout):\n", COMPACT_LAYOUT ? "compact" : "default");
+    for (uint8_t i = 0; i < memoryBudgetEntries; i++) {
+        Serial.printf("  %-16s %6lu B\n", memoryBudget[i].module, (unsigned long)memoryBudget[i].bytes);
+    }
+    Serial.printf("  %-16s %6lu B, heap free %lu B\n", "total", (unsigned long)memoryBudgetTotal(), (unsigned long)ESP.getFreeHeap());
+}
+
+size_t formatMemoryBudget(char* out, size_t size) {
+    int len = snprintf(out, size, "{\"total\":%lu,\"compact\":%s,\"modules\":{",
+                       (unsigned long)memoryBudgetTotal(), COMPACT_LAYOUT ? "true" : "false");
+    for (uint8_t i = 0; i < memoryBudgetEntries && len < (int)size; i++) {
+        len += snprintf(out + len, size - len, "%s\"%s\":%lu", i ? "," : "",
+                        memoryBudget[i].module, (unsigned long)memoryBudget[i].bytes);
+    }
+    if (len < (int)size) len += snprintf(out + len, size - len, "}}");
+    return len < (int)size ? len : size - 1;
+}
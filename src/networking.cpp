@@ -1,4 +1,5 @@
 #include "networking.h"
+#include <esp_task_wdt.h>
 
 Networking::Networking() : mqttClient(espClient){}
 
@@ -11,6 +12,7 @@ void Networking::begin() {
         } else {
             Serial.println("MQTT not configured - running in offline mode");
         }
+        xTaskCreatePinnedToCore(taskEntry, "network", NET_TASK_STACK, this, NET_TASK_PRIORITY, &taskHandle, NET_TASK_CORE);
     } else {
         Serial.println("WiFi not configured - running in offline mode");
         WiFi.mode(WIFI_OFF);  // Disable WiFi to save power
@@ -48,6 +50,7 @@ void Networking::reconnectMQTT() {
     clientId += String(random(0xffff), HEX);
     if (mqttClient.connect(clientId.c_str(), MQTT_USERNAME, MQTT_PASSWORD)) {
         Serial.println("MQTT connected!");
+        reconnects.fetch_add(1, std::memory_order_relaxed);
     } else {
         Serial.print("MQTT connection failed, rc=");
         Serial.println(mqttClient.state());
@@ -66,43 +69,113 @@ bool Networking::isTimeSet() {
     return now > 1600000000;  // Time is after September 2020
 }
 
-void Networking::loop() {
+void Networking::taskEntry(void* arg) {
+    static_cast<Networking*>(arg)->taskLoop();
+}
 
-    if (WIFI_CONFIGURED && millis() - lastStatusCheck > NET_STATUS_INTERVAL_MS) {
-        lastStatusCheck = millis();
+// Network task: the only user of WiFi, TLS and PubSubClient after begin()
+void Networking::taskLoop() {
+    esp_task_wdt_add(NULL);
+    for (;;) {
+        esp_task_wdt_reset();
+        manageConnection();
+        bool session = MQTT_CONFIGURED && wifiConnected.load(std::memory_order_relaxed) && mqttClient.connected();
+        if (session) {
+            mqttClient.loop();
+            drainQueue();
+            session = mqttClient.connected();
+        }
+        mqttConnected.store(session, std::memory_order_release);
 
-        bool wifiConnected = WiFi.status() == WL_CONNECTED;
-        display->updateWifiStatus(wifiConnected);
-        display->updateNTPStatus(isTimeSet());
+        // Woken by publish(), otherwise polls for keep-alive and reconnects
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NET_POLL_MS));
+    }
+}
+
+void Networking::manageConnection() {
+    bool wifiUp = WiFi.status() == WL_CONNECTED;
+    wifiConnected.store(wifiUp, std::memory_order_release);
+    rssi.store(wifiUp ? WiFi.RSSI() : 0, std::memory_order_relaxed);
+
+    if (!wifiUp) {
+        // PubSubClient notices a dead link only on its next socket error;
+        // the session is down with the link, not once it times out
+        mqttConnected.store(false, std::memory_order_release);
+
+        // Short dropouts are handled by the driver's auto-reconnect.
+        // Only force a full re-association if we stay offline too long.
+        if (!wifiWasDown) {
+            wifiWasDown = true;
+            wifiDownSince = millis();
+        } else if (millis() - wifiDownSince > WIFI_FORCE_RECONNECT_MS) {
+            forceWiFiReconnect();
+            wifiDownSince = millis();
+        }
+        return;
+    }
+    wifiWasDown = false;
+
+    // connect() blocks this task for up to 2 x NET_TIMEOUT_S, so rate-limit it
+    if (MQTT_CONFIGURED && !mqttClient.connected() && millis() - lastMqttAttempt > MQTT_RETRY_INTERVAL_MS) {
+        lastMqttAttempt = millis();
+        reconnectMQTT();
+    }
+}
 
-        if (!wifiConnected) {
-            display->updateMqttStatus(false);
-            // Short dropouts are handled by the driver's auto-reconnect.
-            // Only force a full re-association if we stay offline too long.
-            if (!wifiWasDown) {
-                wifiWasDown = true;
-                wifiDownSince = millis();
-            } else if (millis() - wifiDownSince > WIFI_FORCE_RECONNECT_MS) {
-                forceWiFiReconnect();
-                wifiDownSince = millis();
-            }
+// Oldest first; a message that fails because the session dropped stays queued
+void Networking::drainQueue() {
+    OutboundMessage message;
+    while (queue.front(&message)) {
+        esp_task_wdt_reset();
+        if (mqttClient.publish(message.topic, message.payload, message.length)) {
+            sent.fetch_add(1, std::memory_order_relaxed);
+        } else if (!mqttClient.connected()) {
+            return;
         } else {
-            wifiWasDown = false;
-
-            if (MQTT_CONFIGURED) {
-                bool mqttConnected = mqttClient.connected();
-                display->updateMqttStatus(mqttConnected);
-                // connect() blocks for up to 2 x NET_TIMEOUT_S, so rate-limit it
-                if (!mqttConnected && millis() - lastMqttAttempt > MQTT_RETRY_INTERVAL_MS) {
-                    lastMqttAttempt = millis();
-                    reconnectMQTT();
-                }
-            }
+            failed.fetch_add(1, std::memory_order_relaxed);
         }
+        queue.pop();
     }
+}
+
+// Producer side, loop() only: never blocks
+bool Networking::publish(const char* topic, const uint8_t* payload, size_t length, NetPriority priority) {
+    static const uint32_t limits[NET_PRIORITIES] = {
+        NET_QUEUE_BYTES * NET_BULK_SHARE / 100,
+        NET_QUEUE_BYTES - NET_EVENT_RESERVE,
+        NET_QUEUE_BYTES,
+    };
+    if (!WIFI_CONFIGURED || !MQTT_CONFIGURED) return false;
+    if (length > NET_QUEUE_BYTES || !queue.push(topic, payload, length, limits[priority])) {
+        rejected[priority]++;
+        return false;
+    }
+    peak = max(peak, queue.used());
+    xTaskNotifyGive(taskHandle);
+    return true;
+}
+
+NetworkStats Networking::getStats() {
+    NetworkStats stats;
+    stats.queued = queue.used();
+    stats.peak = peak;
+    stats.sent = sent.load(std::memory_order_relaxed);
+    stats.failed = failed.load(std::memory_order_relaxed);
+    for (uint8_t p = 0; p < NET_PRIORITIES; p++) stats.rejected[p] = rejected[p];
+    stats.reconnects = reconnects.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Connection state for the display, from the flags the network task keeps
+void Networking::loop() {
 
-    if (MQTT_CONFIGURED) {
-        mqttClient.loop();
+    if (WIFI_CONFIGURED && millis() - lastStatusCheck > NET_STATUS_INTERVAL_MS) {
+        lastStatusCheck = millis();
+
+        bool wifiUp = wifiConnected.load(std::memory_order_acquire);
+        display->updateWifiStatus(wifiUp);
+        display->updateNTPStatus(isTimeSet());
+        display->updateMqttStatus(isConnected());
     }
 
 }
@@ -0,0 +1,65 @@
+#include "outbound_queue.h"
+
+#define ENTRY_PADDING 0x01
+
+// u16 entry size (8-byte aligned, so a padding header always fits), u16 payload length, u8 topic length
+// (including the terminator), u8 flags, u16 reserved, then topic and payload
+struct EntryHeader {
+    uint16_t size;
+    uint16_t length;
+    uint8_t topicLength;
+    uint8_t flags;
+    uint16_t reserved;
+};
+static_assert(sizeof(EntryHeader) == OUTBOUND_HEADER, "Outbound entry header layout");
+
+bool OutboundQueue::push(const char* topic, const uint8_t* payload, uint16_t length, uint32_t limit) {
+    size_t topicLength = strlen(topic) + 1;
+    if (topicLength > 255) return false;
+    uint32_t size = (OUTBOUND_HEADER + topicLength + length + OUTBOUND_HEADER - 1) & ~(OUTBOUND_HEADER - 1u);
+
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+    uint32_t offset = h % NET_QUEUE_BYTES;
+    uint32_t padding = NET_QUEUE_BYTES - offset < size ? NET_QUEUE_BYTES - offset : 0;
+    if ((h - t) + padding + size > min<uint32_t>(limit, NET_QUEUE_BYTES)) return false;
+
+    if (padding) {
+        EntryHeader pad{(uint16_t)padding, 0, 0, ENTRY_PADDING, 0};
+        memcpy(buffer + offset, &pad, sizeof(pad));
+        h += padding;
+        offset = 0;
+    }
+    EntryHeader entry{(uint16_t)size, length, (uint8_t)topicLength, 0, 0};
+    memcpy(buffer + offset, &entry, sizeof(entry));
+    memcpy(buffer + offset + OUTBOUND_HEADER, topic, topicLength);
+    memcpy(buffer + offset + OUTBOUND_HEADER + topicLength, payload, length);
+    head.store(h + size, std::memory_order_release);
+    return true;
+}
+
+bool OutboundQueue::front(OutboundMessage* message) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        if (t == head.load(std::memory_order_acquire)) return false;
+        EntryHeader entry;
+        memcpy(&entry, buffer + t % NET_QUEUE_BYTES, sizeof(entry));
+        if (entry.flags & ENTRY_PADDING) {
+            t += entry.size;
+            tail.store(t, std::memory_order_release);
+            continue;
+        }
+        const uint8_t* p = buffer + t % NET_QUEUE_BYTES + OUTBOUND_HEADER;
+        message->topic = (const char*)p;
+        message->payload = p + entry.topicLength;
+        message->length = entry.length;
+        return true;
+    }
+}
+
+void OutboundQueue::pop() {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    EntryHeader entry;
+    memcpy(&entry, buffer + t % NET_QUEUE_BYTES, sizeof(entry));
+    tail.store(t + entry.size, std::memory_order_release);
+}
@@ -0,0 +1,162 @@
+#include "payload_codec.h"
+
+// Rounded after saturating: lround() is undefined for NaN, inf and results
+// outside long, which a failing estimator can produce
+static long roundSaturated(double v, double low, double high) {
+    return lround(constrain(v, low, high));
+}
+
+// Little-endian field writer; fixed-point values are rounded and saturated,
+// non-finite values become the field's missing code (or 0 for unsigned u32)
+struct PayloadWriter {
+    uint8_t* p;
+    void u8(uint8_t v) { *p++ = v; }
+    void u16(uint16_t v) { for (uint8_t b = 0; b < 2; b++) *p++ = v >> (8 * b); }
+    void u32(uint32_t v) { for (uint8_t b = 0; b < 4; b++) *p++ = v >> (8 * b); }
+    void u64(uint64_t v) { for (uint8_t b = 0; b < 8; b++) *p++ = v >> (8 * b); }
+    void fixedU16(double v, double scale) {
+        u16(isfinite(v) ? (uint16_t)roundSaturated(v * scale, 0, PAYLOAD_MISSING_U16 - 1) : PAYLOAD_MISSING_U16);
+    }
+    void fixedI16(double v, double scale) {
+        u16((uint16_t)(isfinite(v) ? (int16_t)roundSaturated(v * scale, -32767, 32767) : PAYLOAD_MISSING_I16));
+    }
+    void fixedU32(double v, double scale) {
+        u32(isfinite(v) && v > 0 ? (uint32_t)min(v * scale + 0.5, 4294967295.0) : 0);
+    }
+    void fixedI32(double v, double scale) {
+        u32((uint32_t)(isfinite(v) ? (int32_t)roundSaturated(v * scale, -2147483647.0, 2147483647.0) : PAYLOAD_MISSING_I32));
+    }
+};
+
+static uint8_t measurementFlags(const FrequencyAlert& alert) {
+    const FrequencyAnalysis& analysis = alert.frequencyAnalysis;
+    return (alert.hasAlert ? PAYLOAD_FLAG_ALERT : 0)
+         | (analysis.isValidSignal ? PAYLOAD_FLAG_VALID : 0)
+         | (analysis.fineValid ? PAYLOAD_FLAG_FINE : 0)
+         | (analysis.outlier ? PAYLOAD_FLAG_OUTLIER : 0)
+         | (analysis.fllLocked ? PAYLOAD_FLAG_FLL_LOCKED : 0)
+         | (analysis.harmonicsValid ? PAYLOAD_FLAG_HARMONICS : 0);
+}
+
+static int64_t measurementTime(const FrequencyAlert& alert) {
+    return (int64_t)alert.frequencyAnalysis.time.tv_sec * 1000 + alert.frequencyAnalysis.time.tv_usec / 1000;
+}
+
+size_t encodeMeasurement(const FrequencyAlert& alert, const SystemMetrics& metrics, uint8_t* out, size_t size) {
+    if (size < PAYLOAD_BINARY_SIZE) return 0;
+    const FrequencyAnalysis& analysis = alert.frequencyAnalysis;
+    PayloadWriter w{out};
+
+    w.u8(PAYLOAD_VERSION);
+    w.u8(measurementFlags(alert));
+    w.u8(alert.alertType);
+    w.u8((ROCOF_WINDOWS << 4) | (HARMONIC_MAX - 1));
+
+    w.u64(measurementTime(alert));
+    w.fixedU16(TARGET_FREQUENCY, 1e3);
+    w.fixedU32(analysis.frequency, 1e6);
+    w.fixedU32(analysis.coarseFrequency, 1e6);
+    w.fixedU32(analysis.fllFrequency, 1e6);
+    w.fixedU32(analysis.amplitude, 1);
+    w.fixedU16(analysis.quality, 1e4);
+
+    w.fixedI32(alert.ramp, 1e6);
+    for (uint8_t i = 0; i < ROCOF_WINDOWS; i++) {
+        w.fixedI32(alert.rocof[i], 1e6);
+    }
+    w.fixedU16(analysis.rocofSigma, 1e4);
+
+    w.fixedU16(analysis.harmonicsValid ? analysis.thd : NAN, 1e2);
+    for (uint8_t h = 0; h < HARMONIC_MAX - 1; h++) {
+        w.fixedU16(analysis.harmonicsValid ? analysis.harmonics[h] : NAN, 1e2);
+    }
+
+    w.u16(min(alert.analyzingDelay, 65535UL));
+    w.fixedI16(analysis.clockPpm, 1e2);
+    w.u32(metrics.freeHeap);
+    w.fixedU16(metrics.heapUsage, 1e1);
+    w.u16(metrics.cpuFreq);
+    w.u8((uint8_t)metrics.rssi);
+    return w.p - out;
+}
+
+size_t encodeRawFrame(const RawFrame& frame, uint8_t* out, size_t size) {
+    if (size < PAYLOAD_RAW_SIZE) return 0;
+    PayloadWriter w{out};
+    w.u32(frame.sampleIndex);
+    w.u16(PHASE_BLOCK_SIZE);
+    w.u8(ADC_SAMPLE_BITS);
+    w.u8(0);
+    w.u32(SAMPLING_FREQUENCY);
+    for (uint16_t i = 0; i < PHASE_BLOCK_SIZE; i++) w.u16(frame.samples[i]);
+    return w.p - out;
+}
+
+void BatchEncoder::reset() {
+    bodyLength = 0;
+    samples = 0;
+    flags = 0;
+    alertType = ALARM_NONE;
+    lastFrequency = 0;
+    lastAmplitude = 0;
+}
+
+// Zigzag maps small negative and positive deltas to small codes, LEB128 varint
+void BatchEncoder::putVarint(int32_t delta) {
+    uint32_t v = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    while (v >= 0x80) {
+        body[bodyLength++] = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    body[bodyLength++] = v;
+}
+
+bool BatchEncoder::add(const FrequencyAlert& alert) {
+    int64_t time = measurementTime(alert);
+
+    // Timestamps are implicit: a measurement off the interval grid starts a new batch
+    if (samples) {
+        int64_t expected = lastTime + PAYLOAD_BATCH_INTERVAL_MS;
+        if (full() || time < expected - PAYLOAD_BATCH_INTERVAL_MS / 2 || time > expected + PAYLOAD_BATCH_INTERVAL_MS / 2) {
+            return false;
+        }
+        lastTime = expected;
+    } else {
+        baseTime = time;
+        lastTime = time;
+        startedAt = millis();
+    }
+
+    const FrequencyAnalysis& analysis = alert.frequencyAnalysis;
+    // No missing code in a delta stream: non-finite values go out as nominal / 0
+    double offset = isfinite(analysis.frequency) ? (analysis.frequency - TARGET_FREQUENCY) * 1e4 : 0;
+    int32_t frequency = roundSaturated(offset, -1e9, 1e9);
+    int32_t amplitude = isfinite(analysis.amplitude) ? roundSaturated(analysis.amplitude, 0, 1e9) : 0;
+    putVarint(frequency - lastFrequency);
+    putVarint(amplitude - lastAmplitude);
+    lastFrequency = frequency;
+    lastAmplitude = amplitude;
+    flags |= measurementFlags(alert);
+    alertType = alert.alertType;
+    samples++;
+    return true;
+}
+
+size_t BatchEncoder::finish(const SystemMetrics& metrics, uint8_t* out, size_t size) {
+    if (size < PAYLOAD_BATCH_HEADER + bodyLength) return 0;
+    PayloadWriter w{out};
+    w.u8(PAYLOAD_BATCH_VERSION);
+    w.u8(flags);
+    w.u8(alertType);
+    w.u8(samples);
+    w.u64(baseTime);
+    w.u16(PAYLOAD_BATCH_INTERVAL_MS);
+    w.fixedU16(TARGET_FREQUENCY, 1e3);
+    w.u32(metrics.freeHeap);
+    w.fixedU16(metrics.heapUsage, 1e1);
+    w.u16(metrics.cpuFreq);
+    w.u8((uint8_t)metrics.rssi);
+    w.u8(0);
+    memcpy(w.p, body, bodyLength);
+    return w.p + bodyLength - out;
+}
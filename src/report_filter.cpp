@@ -0,0 +1,106 @@
+#include "report_filter.h"
+
+void SwingingDoor::start(int64_t ms, double value) {
+    anchorMs = ms;
+    anchor = value;
+    upper = INFINITY;
+    lower = -INFINITY;
+}
+
+bool SwingingDoor::admits(int64_t ms, double value, double deviation) const {
+    double dt = ms - anchorMs;
+    if (dt <= 0) return fabs(value - anchor) <= deviation;
+    return max(lower, (value - deviation - anchor) / dt) <= min(upper, (value + deviation - anchor) / dt);
+}
+
+void SwingingDoor::add(int64_t ms, double value, double deviation) {
+    double dt = ms - anchorMs;
+    if (dt <= 0) return;
+    upper = min(upper, (value + deviation - anchor) / dt);
+    lower = max(lower, (value - deviation - anchor) / dt);
+}
+
+double SwingingDoor::valueAt(int64_t ms, double value) const {
+    double dt = ms - anchorMs;
+    if (dt <= 0) return anchor;
+    return anchor + constrain((value - anchor) / dt, lower, upper) * dt;
+}
+
+static int64_t alertTime(const FrequencyAlert& alert) {
+    return (int64_t)alert.frequencyAnalysis.time.tv_sec * 1000 + alert.frequencyAnalysis.time.tv_usec / 1000;
+}
+
+// Frequency only takes part with a valid signal
+static bool frequencyValid(const FrequencyAlert& alert) {
+    return alert.frequencyAnalysis.isValidSignal && isfinite(alert.frequencyAnalysis.frequency);
+}
+
+bool ReportFilter::admits(int64_t ms, const FrequencyAlert& alert) const {
+    const FrequencyAnalysis& analysis = alert.frequencyAnalysis;
+    return (!frequencyValid(alert) || frequency.admits(ms, analysis.frequency, REPORT_FREQ_DEADBAND))
+        && amplitude.admits(ms, analysis.amplitude, REPORT_AMP_DEADBAND);
+}
+
+void ReportFilter::add(int64_t ms, const FrequencyAlert& alert) {
+    if (frequencyValid(alert)) frequency.add(ms, alert.frequencyAnalysis.frequency, REPORT_FREQ_DEADBAND);
+    amplitude.add(ms, alert.frequencyAnalysis.amplitude, REPORT_AMP_DEADBAND);
+    held = alert;
+    hasHeld = true;
+}
+
+FrequencyAlert ReportFilter::vertex(int64_t ms, const FrequencyAlert& alert) const {
+    FrequencyAlert report = alert;
+    FrequencyAnalysis& analysis = report.frequencyAnalysis;
+    if (frequencyValid(alert)) {
+        analysis.frequency = frequency.valueAt(ms, analysis.frequency);
+        report.deviation = fabs(analysis.frequency - TARGET_FREQUENCY);
+    }
+    analysis.amplitude = amplitude.valueAt(ms, analysis.amplitude);
+    return report;
+}
+
+void ReportFilter::restart(int64_t ms, const FrequencyAlert& report) {
+    frequency.start(ms, report.frequencyAnalysis.frequency);
+    amplitude.start(ms, report.frequencyAnalysis.amplitude);
+    hasHeld = false;
+}
+
+uint8_t ReportFilter::update(const FrequencyAlert& alert, FrequencyAlert* out) {
+    int64_t ms = alertTime(alert);
+    bool valid = frequencyValid(alert);
+    bool changed = !started || alert.hasAlert || alert.hasAlert != lastAlert
+                || alert.alertType != lastType || valid != lastValid;
+    started = true;
+    lastAlert = alert.hasAlert;
+    lastType = alert.alertType;
+    lastValid = valid;
+    uint8_t count = 0;
+
+    // Unmodified at once; the held result closes the quiet segment before it
+    if (changed) {
+        if (hasHeld) out[count++] = vertex(alertTime(held), held);
+        out[count++] = alert;
+        restart(ms, alert);
+        return count;
+    }
+
+    if (admits(ms, alert)) {
+        add(ms, alert);
+        if (ms - frequency.anchorMs < REPORT_HEARTBEAT_MS) return 0;
+        out[count++] = vertex(ms, alert);
+        restart(ms, out[0]);
+        return count;
+    }
+
+    // Doors broken: the held result is the vertex, this one starts the next segment
+    if (!hasHeld) {
+        out[count++] = alert;
+        restart(ms, alert);
+        return count;
+    }
+    int64_t heldMs = alertTime(held);
+    out[count++] = vertex(heldMs, held);
+    restart(heldMs, out[0]);
+    add(ms, alert);
+    return count;
+}
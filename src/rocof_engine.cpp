@@ -0,0 +1,55 @@
+#include "rocof_engine.h"
+
+RocofEngine::RocofEngine() {
+    for (uint8_t w = 0; w < ROCOF_WINDOWS; w++) {
+        points[w] = (uint16_t)(kRocofWindowMs[w] / ROCOF_SLICE_MS) + 1;
+    }
+    reset();
+}
+
+void RocofEngine::reset() {
+    for (uint8_t w = 0; w < ROCOF_WINDOWS; w++) {
+        filled[w] = 0;
+        sumY[w] = 0;
+        sumXY[w] = 0;
+    }
+    started = false;
+}
+
+void RocofEngine::update(double frequency, unsigned long millis) {
+    // Equal spacing is assumed: a dropped slice restarts the windows
+    if (started && millis - lastMillis > 1.5 * ROCOF_SLICE_MS) {
+        reset();
+    }
+    started = true;
+    lastMillis = millis;
+
+    int32_t y = (int32_t)lround((frequency - TARGET_FREQUENCY) * 1e6);
+    for (uint8_t w = 0; w < ROCOF_WINDOWS; w++) {
+        uint16_t n = points[w];
+        if (filled[w] < n) {
+            sumXY[w] += (int64_t)filled[w] * y;
+            sumY[w] += y;
+            filled[w]++;
+        } else {
+            int32_t oldest = history[(head + ROCOF_HISTORY - n) % ROCOF_HISTORY];
+            sumXY[w] -= sumY[w] - oldest;
+            sumXY[w] += (int64_t)(n - 1) * y;
+            sumY[w] += y - oldest;
+        }
+    }
+    history[head] = y;
+    head = (head + 1) % ROCOF_HISTORY;
+}
+
+// slope = (N Sxy - Sx Sy) / (N Sxx - Sx^2), Sx and Sxx fixed for x = 0..N-1
+float RocofEngine::getRocof(uint8_t window) {
+    int64_t n = points[window];
+    if (filled[window] < n) {
+        return NAN;
+    }
+    int64_t sx = n * (n - 1) / 2;
+    int64_t sxx = (n - 1) * n * (2 * n - 1) / 6;
+    double slope = (double)(n * sumXY[window] - sx * sumY[window]) / (double)(n * sxx - sx * sx);  // uHz per slice
+    return (float)(slope * 1e-6 * 1000.0 / ROCOF_SLICE_MS);
+}
@@ -0,0 +1,126 @@
+#include "sample_clock.h"
+#include <esp_sntp.h>
+#include <esp_timer.h>
+
+SampleClock* SampleClock::instance = nullptr;
+
+SampleClock::SampleClock() {
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    refUtc = now.tv_sec + now.tv_usec * 1e-6;
+    anchorMicros = esp_timer_get_time();
+}
+
+void SampleClock::begin() {
+    instance = this;
+    sntp_set_sync_interval(TIMEBASE_SYNC_INTERVAL_MS);
+    sntp_set_time_sync_notification_cb(onTimeSync);
+    sntp_restart();  // A running client (configTime() came first) only takes the interval on restart
+}
+
+void SampleClock::markRead(uint32_t sampleCount) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&mux);
+    anchorCount = sampleCount;
+    anchorMicros = now;
+    portEXIT_CRITICAL(&mux);
+}
+
+void SampleClock::toTime(uint32_t sampleIndex, struct timeval* time) {
+    portENTER_CRITICAL(&mux);
+    double utc = refUtc + (int32_t)(sampleIndex - refIndex) * period;
+    portEXIT_CRITICAL(&mux);
+    time->tv_sec = (time_t)floor(utc);
+    time->tv_usec = (suseconds_t)((utc - floor(utc)) * 1e6);
+}
+
+unsigned long SampleClock::toMillis(uint32_t sampleIndex) {
+    return (unsigned long)((uint64_t)sampleIndex * 1000 / SAMPLING_FREQUENCY);
+}
+
+double SampleClock::rateCorrection() {
+    portENTER_CRITICAL(&mux);
+    double nominal = 1.0 / SAMPLING_FREQUENCY;
+    double p = period;
+    portEXIT_CRITICAL(&mux);
+    return nominal / p;
+}
+
+float SampleClock::getPpm() {
+    return (float)((rateCorrection() - 1.0) * 1e6);
+}
+
+// Runs in the lwIP task right after SNTP has set the system time
+void SampleClock::onTimeSync(struct timeval* tv) {
+    if (instance != nullptr && tv != nullptr) {
+        instance->addSyncPoint(*tv);
+    }
+}
+
+void SampleClock::addSyncPoint(const struct timeval& tv) {
+    // Sample index at this instant, extrapolated from the last anchor. The
+    // backend's constant latency ends up in the offset, not in the ppm.
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&mux);
+    uint32_t count = anchorCount;
+    int64_t micros = anchorMicros;
+    double predicted = refUtc + (int32_t)(count - refIndex) * period;
+    portEXIT_CRITICAL(&mux);
+    uint32_t index = count + (uint32_t)llround((now - micros) * 1e-6 * SAMPLING_FREQUENCY);
+    double utc = tv.tv_sec + tv.tv_usec * 1e-6;
+    predicted += (int32_t)(index - count) * period;
+
+    // A step of the system clock or a gap in the sampling invalidates the
+    // history (the first point always starts a new regression)
+    if (!synced || fabs(utc - predicted) * 1000 > TIMEBASE_STEP_MS) {
+        if (synced) Serial.printf("Timebase: %.1f ms off, restarting drift regression\n", (utc - predicted) * 1000);
+        pointCount = 0;
+    }
+    if (pointCount == TIMEBASE_POINTS) {
+        memmove(pointIndex, &pointIndex[1], (TIMEBASE_POINTS - 1) * sizeof(pointIndex[0]));
+        memmove(pointUtc, &pointUtc[1], (TIMEBASE_POINTS - 1) * sizeof(pointUtc[0]));
+        pointCount--;
+    }
+    pointIndex[pointCount] = index;
+    pointUtc[pointCount] = utc;
+    pointCount++;
+    fit();
+}
+
+// Least squares relative to the newest point: x in samples, y in seconds
+void SampleClock::fit() {
+    const uint16_t last = pointCount - 1;
+    double newPeriod = 1.0 / SAMPLING_FREQUENCY;
+    double offset = 0;
+    double span = pointUtc[last] - pointUtc[0];
+
+    if (pointCount >= 2 && span >= TIMEBASE_MIN_SPAN_S) {
+        double sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (uint16_t i = 0; i < pointCount; i++) {
+            double x = (int32_t)(pointIndex[i] - pointIndex[last]);
+            double y = pointUtc[i] - pointUtc[last];
+            sx += x;
+            sy += y;
+            sxx += x * x;
+            sxy += x * y;
+        }
+        double n = pointCount;
+        double slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+        double ppm = (1.0 / (slope * SAMPLING_FREQUENCY) - 1.0) * 1e6;
+        if (fabs(ppm) <= TIMEBASE_MAX_PPM) {
+            newPeriod = slope;
+            offset = (sy - slope * sx) / n;
+        } else {
+            Serial.printf("Timebase: implausible drift %.1f ppm ignored\n", ppm);
+        }
+    } else if (synced) {
+        newPeriod = period;  // Keep the last estimate while the span rebuilds
+    }
+
+    portENTER_CRITICAL(&mux);
+    refIndex = pointIndex[last];
+    refUtc = pointUtc[last] + offset;
+    period = newPeriod;
+    synced = true;
+    portEXIT_CRITICAL(&mux);
+}
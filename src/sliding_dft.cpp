@@ -0,0 +1,57 @@
+#include "sliding_dft.h"
+
+static_assert((ANALYSIS_SIZE & (ANALYSIS_SIZE - 1)) == 0, "Sliding DFT indexes twiddles with a mask");
+
+int16_t SlidingDft::cosTable[ANALYSIS_SIZE];
+
+SlidingDft::SlidingDft() {
+    buildTable();
+}
+
+void SlidingDft::buildTable() {
+    for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) {
+        cosTable[i] = (int16_t)lround(32767.0 * cos(TWO_PI * i / ANALYSIS_SIZE));
+    }
+}
+
+// S_k += (x[m] - x[m-N]) * exp(-j*2*pi*k*m/N); both samples share the twiddle
+void SlidingDft::update(uint32_t sampleIndex, int32_t newest, int32_t oldest) {
+    const uint32_t mask = ANALYSIS_SIZE - 1;
+    int32_t delta = newest - oldest;
+    uint32_t step = sampleIndex & mask;
+    uint32_t phase = (SDFT_FIRST_BIN * step) & mask;
+
+    for (uint16_t b = 0; b < SDFT_NUM_BINS; b++) {
+        accRe[b] += delta * cosTable[phase];
+        accIm[b] -= delta * cosTable[(phase + 3 * ANALYSIS_SIZE / 4) & mask];  // sin = cos(x - pi/2)
+        phase = (phase + step) & mask;
+    }
+    nextIndex = sampleIndex + 1;
+}
+
+void SlidingDft::snapshot(SlidingDftSnapshot* out) {
+    memcpy(out->re, accRe, sizeof(accRe));
+    memcpy(out->im, accIm, sizeof(accIm));
+    out->sampleIndex = nextIndex;
+}
+
+// Hamming-windowed magnitudes for SDFT_FIRST_BIN+1 .. SDFT_LAST_BIN-1, scaled
+// like arduinoFFT's output. The window is applied in the frequency domain
+// (0.54 X[k] - 0.23 (X[k-1] + X[k+1])); neighbours are rotated from the
+// absolute-index reference into the window reference first.
+void SlidingDft::toMagnitude(const SlidingDftSnapshot& snapshot, spectrum_t* vReal) {
+    double theta = TWO_PI * (snapshot.sampleIndex % ANALYSIS_SIZE) / ANALYSIS_SIZE;
+    double c = cos(theta);
+    double s = sin(theta);
+
+    for (uint16_t b = 1; b < SDFT_NUM_BINS - 1; b++) {
+        // prev * exp(-j*theta), next * exp(+j*theta)
+        double pRe = snapshot.re[b - 1] * c + snapshot.im[b - 1] * s;
+        double pIm = snapshot.im[b - 1] * c - snapshot.re[b - 1] * s;
+        double nRe = snapshot.re[b + 1] * c - snapshot.im[b + 1] * s;
+        double nIm = snapshot.im[b + 1] * c + snapshot.re[b + 1] * s;
+        double re = 0.54 * snapshot.re[b] - 0.23 * (pRe + nRe);
+        double im = 0.54 * snapshot.im[b] - 0.23 * (pIm + nIm);
+        vReal[SDFT_FIRST_BIN + b] = sqrt(re * re + im * im) / 32767.0;
+    }
+}
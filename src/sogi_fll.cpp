@@ -0,0 +1,85 @@
+#include "sogi_fll.h"
+#include "adc_source.h"
+
+static const float kSamplePeriod = 1.0f / SAMPLING_FREQUENCY;
+
+SogiFll::SogiFll() {
+    dcPole = 1.0f - TWO_PI * SOGI_DC_CUTOFF / SAMPLING_FREQUENCY;
+    omega = TWO_PI * TARGET_FREQUENCY;
+    omegaMin = TWO_PI * SEARCH_MIN_FREQUENCY;
+    omegaMax = TWO_PI * SEARCH_MAX_FREQUENCY;
+    updateCoefficients();
+}
+
+// Bilinear SOGI with prewarped centre: w -> (2 / Ts) * tan(w * Ts / 2)
+//   x = 2 k wT, y = wT^2, D = x + y + 4
+//   v'[n]  = b0 (v[n] - v[n-2])            + a1 v'[n-1]  + a2 v'[n-2]
+//   qv'[n] = qb0 (v[n] + 2 v[n-1] + v[n-2]) + a1 qv'[n-1] + a2 qv'[n-2]
+void SogiFll::updateCoefficients() {
+    float wT = 2.0f * tanf(omega * kSamplePeriod * 0.5f);
+    float x = 2.0f * SOGI_FLL_K * wT;
+    float y = wT * wT;
+    float d = x + y + 4.0f;
+    b0 = x / d;
+    a1 = 2.0f * (4.0f - y) / d;
+    a2 = (x - y - 4.0f) / d;
+    qb0 = SOGI_FLL_K * y / d;
+    coeffCountdown = SOGI_COEFF_INTERVAL;
+}
+
+void SogiFll::update(uint32_t sampleIndex, int32_t sample) {
+    float input = (float)sample;
+    if (!primed) {
+        lastInput = input;  // Start the high-pass at the offset, not at 0
+        primed = true;
+    }
+    float v = input - lastInput + dcPole * lastHighpass;
+    lastInput = input;
+    lastHighpass = v;
+
+    float d = b0 * (v - v2) + a1 * d1 + a2 * d2;
+    float q = qb0 * (v + 2.0f * v1 + v2) + a1 * q1 + a2 * q2;
+
+    // Normalised FLL: dw/dt = -G * k * w * (v - v') * qv' / |v'|^2
+    float energy = d * d + q * q;
+    float w = omega;
+    if (energy > 1.0f) {
+        w -= kSamplePeriod * SOGI_FLL_GAIN * SOGI_FLL_K * w * (v - d) * q / energy;
+        w = min(max(w, omegaMin), omegaMax);
+    }
+
+    v2 = v1;
+    v1 = v;
+    d2 = d1;
+    d1 = d;
+    q2 = q1;
+    q1 = q;
+    omega = w;
+    omegaSum += w;
+    omegaCount++;
+    nextIndex = sampleIndex + 1;
+
+    if (--coeffCountdown == 0) {
+        updateCoefficients();
+    }
+}
+
+void SogiFll::snapshot(SogiFllOutput* out, bool restartMean) {
+    float d = d1;
+    float q = q1;
+    float w = omega;
+    float mean = omegaCount ? omegaSum / omegaCount : w;
+    uint32_t index = nextIndex;
+    if (restartMean) {
+        omegaSum = 0;
+        omegaCount = 0;
+    }
+
+    // qv' lags v' by 90 degrees: v' = A cos(phi), qv' = A sin(phi)
+    out->frequency = w / TWO_PI;
+    out->frequencyMean = mean / TWO_PI;
+    out->amplitude = sqrtf(d * d + q * q);
+    out->phase = atan2f(q, d);
+    out->sampleIndex = index - 1;
+    out->locked = out->amplitude > SOGI_MIN_AMPLITUDE * ADC_SAMPLE_SCALE && w > omegaMin && w < omegaMax;
+}
@@ -0,0 +1,167 @@
+#include "stream_stats.h"
+
+static const uint16_t statsIntervals[STATS_INTERVAL_COUNT] = STATS_INTERVALS;
+static const float statsQuantiles[STATS_QUANTILE_COUNT] = STATS_QUANTILES;
+static const float bandLimits[STATS_BANDS - 1] = {
+    STANDARD_RANGE_THRESHOLD, ALERT_RANGE_THRESHOLD, LEVEL1_EMERGENCY_THRESHOLD, LEVEL2_EMERGENCY_THRESHOLD
+};
+
+void P2Quantile::begin(float quantile) {
+    p = quantile;
+    count = 0;
+    const double d[5] = {1, 1 + 2 * p, 1 + 4 * p, 3 + 2 * p, 5};
+    const double inc[5] = {0, p / 2, p, (1 + p) / 2, 1};
+    for (uint8_t i = 0; i < 5; i++) {
+        position[i] = i + 1;
+        desired[i] = d[i];
+        increment[i] = inc[i];
+    }
+}
+
+void P2Quantile::add(double x) {
+    // The first five samples are the initial markers
+    if (count < 5) {
+        uint8_t i = count++;
+        while (i > 0 && height[i - 1] > x) {
+            height[i] = height[i - 1];
+            i--;
+        }
+        height[i] = x;
+        return;
+    }
+    count++;
+
+    // Cell of x, extending the extreme markers
+    uint8_t k;
+    if (x < height[0]) {
+        height[0] = x;
+        k = 0;
+    } else if (x >= height[4]) {
+        height[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (x >= height[k + 1]) k++;
+    }
+    for (uint8_t i = k + 1; i < 5; i++) position[i]++;
+    for (uint8_t i = 0; i < 5; i++) desired[i] += increment[i];
+
+    // Move the middle markers towards their desired positions
+    for (uint8_t i = 1; i < 4; i++) {
+        double d = desired[i] - position[i];
+        if ((d >= 1 && position[i + 1] - position[i] > 1) || (d <= -1 && position[i - 1] - position[i] < -1)) {
+            int8_t step = d > 0 ? 1 : -1;
+            double h = parabolic(i, step);
+            height[i] = (height[i - 1] < h && h < height[i + 1]) ? h : linear(i, step);
+            position[i] += step;
+        }
+    }
+}
+
+double P2Quantile::parabolic(uint8_t i, int8_t d) const {
+    return height[i] + d / (position[i + 1] - position[i - 1]) *
+           ((position[i] - position[i - 1] + d) * (height[i + 1] - height[i]) / (position[i + 1] - position[i]) +
+            (position[i + 1] - position[i] - d) * (height[i] - height[i - 1]) / (position[i] - position[i - 1]));
+}
+
+double P2Quantile::linear(uint8_t i, int8_t d) const {
+    return height[i] + d * (height[i + d] - height[i]) / (position[i + d] - position[i]);
+}
+
+// Up to five samples the markers are the sorted samples themselves
+double P2Quantile::value() const {
+    if (count == 0) return NAN;
+    if (count <= 5) return height[(uint8_t)lround(p * (count - 1))];
+    return height[2];
+}
+
+void StreamMoments::begin() {
+    count = 0;
+    mean = 0;
+    m2 = 0;
+    min = INFINITY;
+    max = -INFINITY;
+    for (uint8_t q = 0; q < STATS_QUANTILE_COUNT; q++) {
+        quantiles[q].begin(statsQuantiles[q]);
+    }
+}
+
+void StreamMoments::add(double x) {
+    count++;
+    double delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+    if (x < min) min = x;
+    if (x > max) max = x;
+    for (uint8_t q = 0; q < STATS_QUANTILE_COUNT; q++) {
+        quantiles[q].add(x);
+    }
+}
+
+StreamStats::StreamStats() {
+    for (uint8_t i = 0; i < STATS_INTERVAL_COUNT; i++) {
+        begin(i, 0);
+    }
+}
+
+void StreamStats::begin(uint8_t i, time_t start) {
+    Aggregate& a = aggregates[i];
+    a.start = start;
+    a.invalid = 0;
+    memset(a.bandSlices, 0, sizeof(a.bandSlices));
+    a.frequency.begin();
+    a.deviation.begin();
+}
+
+uint8_t StreamStats::update(const FrequencyAnalysis& analysis, StatsSummary* closed) {
+    uint8_t count = 0;
+    if (analysis.time.tv_sec < STATS_VALID_TIME) {
+        for (uint8_t i = 0; i < STATS_INTERVAL_COUNT; i++) {
+            if (aggregates[i].start != 0) begin(i, 0);
+        }
+        return 0;
+    }
+    for (uint8_t i = 0; i < STATS_INTERVAL_COUNT; i++) {
+        Aggregate& a = aggregates[i];
+        time_t start = analysis.time.tv_sec - analysis.time.tv_sec % statsIntervals[i];
+
+        // A slice of the next interval closes this one. The first interval
+        // after boot is partial, its count shows how much was seen.
+        if (start != a.start) {
+            if (a.start != 0 && start == a.start + statsIntervals[i]) summarize(i, &closed[count++]);
+            begin(i, start);
+        }
+
+        if (!analysis.isValidSignal) {
+            a.invalid++;
+            continue;
+        }
+        double deviation = fabs(analysis.frequency - TARGET_FREQUENCY);
+        a.frequency.add(analysis.frequency);
+        a.deviation.add(deviation);
+        uint8_t band = 0;
+        while (band < STATS_BANDS - 1 && deviation >= bandLimits[band]) band++;
+        a.bandSlices[band]++;
+    }
+    return count;
+}
+
+void StreamStats::summarize(uint8_t i, StatsSummary* out) const {
+    const Aggregate& a = aggregates[i];
+    out->start = a.start;
+    out->interval = statsIntervals[i];
+    out->count = a.frequency.count;
+    out->invalid = a.invalid;
+    out->freqMin = a.frequency.min;
+    out->freqMax = a.frequency.max;
+    out->freqMean = a.frequency.count ? a.frequency.mean : NAN;
+    out->freqStd = a.frequency.stddev();
+    out->devMax = a.deviation.max;
+    out->devMean = a.deviation.count ? a.deviation.mean : NAN;
+    out->devStd = a.deviation.stddev();
+    for (uint8_t q = 0; q < STATS_QUANTILE_COUNT; q++) {
+        out->freqQuantile[q] = a.frequency.quantiles[q].value();
+        out->devQuantile[q] = a.deviation.quantiles[q].value();
+    }
+    memcpy(out->bandSlices, a.bandSlices, sizeof(out->bandSlices));
+}
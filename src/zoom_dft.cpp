@@ -0,0 +1,91 @@
+#include "zoom_dft.h"
+
+static_assert(ZOOM_OUTPUTS >= 8, "Too few decimated samples for the zoom DFT");
+static_assert(SAMPLING_FREQUENCY / ZOOM_DECIMATION > SEARCH_MAX_FREQUENCY - SEARCH_MIN_FREQUENCY,
+              "Decimated rate must cover the search band");
+
+ZoomDft::ZoomDft() {
+    const double w0 = TWO_PI * ZOOM_CENTER_FREQUENCY / SAMPLING_FREQUENCY;
+
+    // Triangle = two cascaded ZOOM_DECIMATION boxcars (CIC, order 2)
+    double tri[ZOOM_TAPS];
+    for (uint16_t i = 0; i < ZOOM_TAPS; i++) {
+        tri[i] = min(i + 1, ZOOM_TAPS - i);
+        tapRe[i] = tri[i] * cos(w0 * i);
+        tapIm[i] = -tri[i] * sin(w0 * i);
+    }
+    blockRotRe = cos(w0 * ZOOM_DECIMATION);
+    blockRotIm = -sin(w0 * ZOOM_DECIMATION);
+
+    double hannSum = 0;
+    for (uint16_t m = 0; m < ZOOM_OUTPUTS; m++) {
+        window[m] = 0.5 * (1.0 - cos(TWO_PI * m / (ZOOM_OUTPUTS - 1)));
+        hannSum += window[m];
+    }
+
+    // Coherent gain of the FFT path (arduinoFFT Hamming), so both engines
+    // report the same amplitude for the same signal
+    double hammingSum = 0;
+    for (uint16_t i = 0; i < ANALYSIS_SIZE / 2; i++) {
+        hammingSum += 2 * (0.54 - 0.46 * cos(TWO_PI * i / (ANALYSIS_SIZE - 1)));
+    }
+
+    for (uint16_t k = 0; k < ZOOM_BINS; k++) {
+        double wk = TWO_PI * (binFrequency(k) - ZOOM_CENTER_FREQUENCY) * ZOOM_DECIMATION / SAMPLING_FREQUENCY;
+        coeff[k] = 2 * cos(wk);
+        rotRe[k] = cos(wk);
+        rotIm[k] = -sin(wk);
+    }
+
+    // The low-pass droop (about 8% at the band edges) hits the signal at its
+    // own frequency, i.e. all bins alike. Compensating per bin would tilt
+    // the grid and bias the peak, so only the centre gain is removed.
+    scale = hammingSum / ((double)ZOOM_DECIMATION * ZOOM_DECIMATION * hannSum);
+}
+
+void ZoomDft::compute(const uint16_t* adcData, spectrum_t* magnitude) {
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < ANALYSIS_SIZE; i++) {
+        sum += adcData[i];
+    }
+    float avg = (float)sum / ANALYSIS_SIZE;
+
+    // Mix-down + low-pass + decimate: one complex FIR per output sample,
+    // mixer phase continued from block to block
+    float phRe = 1;
+    float phIm = 0;
+    for (uint16_t m = 0; m < ZOOM_OUTPUTS; m++) {
+        const uint16_t* x = &adcData[m * ZOOM_DECIMATION];
+        float accRe = 0;
+        float accIm = 0;
+        for (uint16_t i = 0; i < ZOOM_TAPS; i++) {
+            float v = x[i] - avg;
+            accRe += v * tapRe[i];
+            accIm += v * tapIm[i];
+        }
+        baseRe[m] = window[m] * (accRe * phRe - accIm * phIm);
+        baseIm[m] = window[m] * (accRe * phIm + accIm * phRe);
+
+        float re = phRe * blockRotRe - phIm * blockRotIm;
+        phIm = phRe * blockRotIm + phIm * blockRotRe;
+        phRe = re;
+    }
+
+    // Complex Goertzel per band bin: |s1 - exp(-j*w) * s2| = |X(w)|
+    for (uint16_t k = 0; k < ZOOM_BINS; k++) {
+        float c = coeff[k];
+        float s1Re = 0, s1Im = 0;
+        float s2Re = 0, s2Im = 0;
+        for (uint16_t m = 0; m < ZOOM_OUTPUTS; m++) {
+            float s0Re = baseRe[m] + c * s1Re - s2Re;
+            float s0Im = baseIm[m] + c * s1Im - s2Im;
+            s2Re = s1Re;
+            s2Im = s1Im;
+            s1Re = s0Re;
+            s1Im = s0Im;
+        }
+        float yRe = s1Re - (rotRe[k] * s2Re - rotIm[k] * s2Im);
+        float yIm = s1Im - (rotRe[k] * s2Im + rotIm[k] * s2Re);
+        magnitude[k] = sqrtf(yRe * yRe + yIm * yIm) * scale;
+    }
+}
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Compares payload_host output with decode_payload.py (make -C tools check-payload).
+
+Each input line holds a payload as hex and the values the device encoded;
+decoded values must match within the field's fixed-point resolution and
+missing values (null) must decode as null.
+"""
+
+import json
+import sys
+
+from decode_payload import decode
+
+# Fixed-point step per field (payload_codec.h); a value may be off by half of it
+RESOLUTION = {"freq": 1e-6, "freqCoarse": 1e-6, "freqFll": 1e-6, "amp": 1, "quality": 1e-4,
+              "ramp": 1e-6, "rocof": 1e-6, "rocofStd": 1e-4, "thd": 1e-2, "harm": 1e-2,
+              "clockPpm": 1e-2, "heapUsage": 0.1}
+BATCH_RESOLUTION = {"freq": 1e-4, "amp": 1}
+
+
+def compare(path, expected, actual, resolution, errors):
+    if isinstance(expected, dict):
+        for key, value in expected.items():
+            compare(path + "." + key, value, actual.get(key) if isinstance(actual, dict) else None,
+                    dict(resolution, **{"": resolution.get(key, 0)}), errors)
+    elif isinstance(expected, list):
+        if not isinstance(actual, list) or len(actual) != len(expected):
+            errors.append("%s: expected %d values, got %r" % (path, len(expected), actual))
+            return
+        for i, value in enumerate(expected):
+            compare("%s[%d]" % (path, i), value, actual[i], resolution, errors)
+    elif expected is None or actual is None:
+        if expected != actual:
+            errors.append("%s: expected %r, got %r" % (path, expected, actual))
+    elif abs(expected - actual) > resolution.get("", 0) / 2 + 1e-9:
+        errors.append("%s: expected %r, got %r" % (path, expected, actual))
+
+
+def main():
+    failed = 0
+    for line in sys.stdin:
+        case = json.loads(line)
+        decoded = decode(bytes.fromhex(case["hex"]))
+        resolution = BATCH_RESOLUTION if "samples" in case["expect"] else RESOLUTION
+        errors = []
+        compare("", case["expect"], decoded, resolution, errors)
+        print("%-12s %3d bytes  %s" % (case["case"], len(case["hex"]) // 2, "ok" if not errors else "FAIL"))
+        for error in errors:
+            print("    " + error)
+        failed += bool(errors)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
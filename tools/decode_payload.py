@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Decode binary measurement payloads (PAYLOAD_FORMAT 1 and 2, journal backfill) into the JSON fields.
+
+Library use:
+    from decode_payload import decode
+    record = decode(payload_bytes)
+
+Command line (one payload per file, '-' reads stdin; --hex for hex text):
+    mosquitto_sub -h broker -t 'public/freqsensor/your_id/bin' -C 1 -N | ./decode_payload.py -
+    mosquitto_sub -h broker -t 'public/freqsensor/your_id/batch' -C 1 -N | ./decode_payload.py -
+    mosquitto_sub -h broker -t 'public/freqsensor/your_id/backfill' -C 1 -N | ./decode_payload.py -
+    ./decode_payload.py --hex 0140050...
+
+Fields the device could not measure, or that were NaN/inf, carry the reserved
+code of their type and decode as null: i32 -2^31, i16 -2^15, u16 0xFFFF.
+In batches (version 2) they arrive as the nominal frequency / zero amplitude.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+ALERT_TYPES = ["AMPL", "ROCOF", "LEVEL2_EMERGENCY_THRESHOLD", "LEVEL1_EMERGENCY_THRESHOLD", "ALERT_RANGE_THRESHOLD"]
+
+FLAG_ALERT = 0x01
+FLAG_VALID = 0x02
+FLAG_FINE = 0x04
+FLAG_OUTLIER = 0x08
+FLAG_FLL_LOCKED = 0x10
+FLAG_HARMONICS = 0x20
+
+MISSING_I32 = -0x80000000
+MISSING_I16 = -0x8000
+MISSING_U16 = 0xFFFF
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def take(self, fmt):
+        value = struct.unpack_from("<" + fmt, self.data, self.offset)[0]
+        self.offset += struct.calcsize(fmt)
+        return value
+
+    def varint(self):
+        value = shift = 0
+        while True:
+            byte = self.data[self.offset]
+            self.offset += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        return (value >> 1) ^ -(value & 1)  # zigzag
+
+    def fixed(self, fmt, scale, missing=None):
+        value = self.take(fmt)
+        return None if value == missing else value / scale
+
+
+def measurement_size(payload, offset=0):
+    counts = payload[offset + 3]
+    return 51 + 4 * (counts >> 4) + 2 * ((counts & 0x0F) + 1)
+
+
+def decode(payload):
+    """Returns a dict with the field names of the JSON encoding; batches
+    (version 2) carry them per measurement in "samples", backfill messages
+    (version 1 records back to back) in "records"."""
+    version = payload[0]
+    if version == 1 and len(payload) > measurement_size(payload):
+        return {"version": version, "records": decode_records(payload)}
+    if version == 1:
+        return decode_measurement(payload)
+    if version == 2:
+        return decode_batch(payload)
+    raise ValueError("unsupported payload version %d" % version)
+
+
+def decode_records(payload):
+    records = []
+    offset = 0
+    while offset < len(payload):
+        size = measurement_size(payload, offset)
+        records.append(decode_measurement(payload[offset:offset + size]))
+        offset += size
+    return records
+
+
+def decode_batch(payload):
+    r = Reader(payload)
+    out = {"version": r.take("B")}
+    flags = r.take("B")
+    alert_type = r.take("B")
+    count = r.take("B")
+    base = r.take("q")
+    interval = r.take("H")
+    nominal = r.fixed("H", 1e3)
+    out["alert"] = bool(flags & FLAG_ALERT)
+    out["alertType"] = ALERT_TYPES[alert_type] if alert_type < len(ALERT_TYPES) else "none"
+    out["interval"] = interval
+    out["freeHeap"] = r.take("I")
+    out["heapUsage"] = r.fixed("H", 1e1, MISSING_U16)
+    out["cpuFreq"] = r.take("H")
+    out["wifiRSSI"] = r.take("b")
+    r.take("B")
+
+    samples = []
+    frequency = amplitude = 0
+    for i in range(count):
+        frequency += r.varint()
+        amplitude += r.varint()
+        samples.append({"time": base + i * interval, "freq": round(nominal + frequency / 1e4, 4), "amp": float(amplitude)})
+    out["samples"] = samples
+    out["nominal"] = nominal
+    if r.offset != len(payload):
+        raise ValueError("payload is %d bytes, schema used %d" % (len(payload), r.offset))
+    return out
+
+
+def decode_measurement(payload):
+    r = Reader(payload)
+    version = r.take("B")
+    flags = r.take("B")
+    alert_type = r.take("B")
+    counts = r.take("B")
+    windows, harmonics = counts >> 4, counts & 0x0F
+
+    out = {"version": version}
+    out["time"] = r.take("q")
+    nominal = r.fixed("H", 1e3)
+    out["freq"] = r.fixed("I", 1e6)
+    out["freqCoarse"] = r.fixed("I", 1e6)
+    out["freqFll"] = r.fixed("I", 1e6)
+    out["amp"] = float(r.take("I"))
+    out["quality"] = r.fixed("H", 1e4, MISSING_U16)
+    out["alert"] = bool(flags & FLAG_ALERT)
+    out["alertType"] = ALERT_TYPES[alert_type] if alert_type < len(ALERT_TYPES) else "none"
+    out["deviation"] = round(abs(out["freq"] - nominal), 6) if flags & FLAG_VALID else 0.0
+    out["ramp"] = r.fixed("i", 1e6, MISSING_I32)
+    out["rocof"] = [r.fixed("i", 1e6, MISSING_I32) for _ in range(windows)]
+    out["rocofStd"] = r.fixed("H", 1e4, MISSING_U16)
+    out["thd"] = r.fixed("H", 1e2, MISSING_U16)
+    harm = [r.fixed("H", 1e2, MISSING_U16) for _ in range(harmonics)]
+    out["harm"] = harm if flags & FLAG_HARMONICS else None
+    out["analyzingDelay"] = r.take("H")
+    out["clockPpm"] = r.fixed("h", 1e2, MISSING_I16)
+    out["freeHeap"] = r.take("I")
+    out["heapUsage"] = r.fixed("H", 1e1, MISSING_U16)
+    out["cpuFreq"] = r.take("H")
+    out["wifiRSSI"] = r.take("b")
+    out["nominal"] = nominal
+    out["validSignal"] = bool(flags & FLAG_VALID)
+    out["fineValid"] = bool(flags & FLAG_FINE)
+    out["outlier"] = bool(flags & FLAG_OUTLIER)
+    out["fllLocked"] = bool(flags & FLAG_FLL_LOCKED)
+    if r.offset != len(payload):
+        raise ValueError("payload is %d bytes, schema used %d" % (len(payload), r.offset))
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="+", help="payload files ('-' for stdin), or hex strings with --hex")
+    parser.add_argument("--hex", action="store_true", help="inputs are hex strings")
+    args = parser.parse_args()
+
+    for item in args.inputs:
+        if args.hex:
+            payload = bytes.fromhex(item)
+        elif item == "-":
+            payload = sys.stdin.buffer.read()
+        else:
+            with open(item, "rb") as f:
+                payload = f.read()
+        print(json.dumps(decode(payload)))
+
+
+if __name__ == "__main__":
+    main()
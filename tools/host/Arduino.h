@@ -0,0 +1,112 @@
+#pragma once
+// Host builds (tools/Makefile): declarations of the Arduino, ESP32 and
+// FreeRTOS API that the device headers use. Nothing is implemented here;
+// each harness defines what its modules actually link.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include <time.h>
+#include <algorithm>
+using std::max; using std::min;
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define TWO_PI 6.283185307179586476925286766559
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define INPUT 1
+#define INPUT_PULLUP 2
+#define OUTPUT 3
+#define LOW 0
+#define HIGH 1
+typedef uint8_t byte;
+typedef int BaseType_t; typedef unsigned UBaseType_t; typedef uint32_t TickType_t;
+typedef void* TaskHandle_t; typedef void* QueueHandle_t; typedef void* SemaphoreHandle_t;
+struct portMUX_TYPE { int x; };
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(m) (void)(m)
+#define portEXIT_CRITICAL(m) (void)(m)
+#define portENTER_CRITICAL_ISR(m) (void)(m)
+#define portEXIT_CRITICAL_ISR(m) (void)(m)
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffff
+#define pdMS_TO_TICKS(x) (x)
+#define portYIELD_FROM_ISR(x) (void)(x)
+#define portTICK_PERIOD_MS 1
+typedef void (*TaskFunction_t)(void*);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*, BaseType_t);
+void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*);
+BaseType_t xTaskNotifyGive(TaskHandle_t);
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void vTaskDelay(TickType_t);
+TickType_t xTaskGetTickCount();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t);
+QueueHandle_t xQueueCreate(UBaseType_t, UBaseType_t);
+BaseType_t xQueueSend(QueueHandle_t, const void*, TickType_t);
+BaseType_t xQueueReceive(QueueHandle_t, void*, TickType_t);
+BaseType_t xQueueOverwrite(QueueHandle_t, const void*);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t);
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t);
+unsigned long millis(); unsigned long micros(); void delay(unsigned long);
+uint16_t analogRead(uint8_t); void pinMode(uint8_t,uint8_t); int digitalRead(uint8_t); void digitalWrite(uint8_t,uint8_t);
+void analogReadResolution(uint8_t);
+long random(long);
+struct hw_timer_t;
+hw_timer_t* timerBegin(uint8_t, uint16_t, bool); void timerAttachInterrupt(hw_timer_t*, void(*)(), bool);
+void timerAlarmWrite(hw_timer_t*, uint64_t, bool); void timerAlarmEnable(hw_timer_t*);
+uint32_t getApbFrequency(); bool setCpuFrequencyMhz(uint32_t);
+void ledcSetup(uint8_t,double,uint8_t); void ledcWriteTone(uint8_t,double); void ledcAttachPin(uint8_t,uint8_t); void ledcDetachPin(uint8_t);
+class String { public: String(const char*); String(long, int); String& operator+=(const String&); const char* c_str() const; };
+#define HEX 16
+class Print { public:
+  size_t print(const char*); size_t print(char); size_t print(double,int=2); size_t print(int); size_t print(unsigned); size_t print(long); size_t print(unsigned long);
+  size_t println(const char*); size_t println(double,int=2); size_t println(int); size_t println(unsigned long); size_t println(); size_t printf(const char*, ...); size_t write(uint8_t); };
+class HardwareSerial : public Print { public: void begin(unsigned long); };
+extern HardwareSerial Serial;
+class EspClass { public: uint32_t getFreeHeap(); uint32_t getHeapSize(); uint8_t getCpuFreqMHz(); void restart(); uint32_t getCycleCount(); uint32_t getMinFreeHeap(); uint32_t getMaxAllocHeap(); };
+extern EspClass ESP;
+#define B00000 0
+#define B00001 1
+#define B00010 2
+#define B00011 3
+#define B00100 4
+#define B00101 5
+#define B00110 6
+#define B00111 7
+#define B01000 8
+#define B01001 9
+#define B01010 10
+#define B01011 11
+#define B01100 12
+#define B01101 13
+#define B01110 14
+#define B01111 15
+#define B10000 16
+#define B10001 17
+#define B10010 18
+#define B10011 19
+#define B10100 20
+#define B10101 21
+#define B10110 22
+#define B10111 23
+#define B11000 24
+#define B11001 25
+#define B11010 26
+#define B11011 27
+#define B11100 28
+#define B11101 29
+#define B11110 30
+#define B11111 31
+void configTime(long, int, const char*);
+#ifndef constrain
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#endif
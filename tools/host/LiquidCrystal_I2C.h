@@ -0,0 +1,6 @@
+#pragma once
+// Host builds (tools/Makefile): declarations only; lcd_host.cpp emulates the controller
+#include <Arduino.h>
+class LiquidCrystal_I2C : public Print { public: LiquidCrystal_I2C(uint8_t,uint8_t,uint8_t); void init(); void backlight(); void clear(); void setCursor(uint8_t,uint8_t); void createChar(uint8_t, uint8_t*); };
+class TwoWire { public: void begin(); void setClock(uint32_t); };
+extern TwoWire Wire;
@@ -0,0 +1,5 @@
+#pragma once
+// Host builds (tools/Makefile): declarations only
+#define FFT_WIN_TYP_HAMMING 1
+#define FFT_FORWARD 1
+class arduinoFFT { public: void Windowing(double*, uint16_t, uint8_t, uint8_t); void Compute(double*, double*, uint16_t, uint8_t); void ComplexToMagnitude(double*, double*, uint16_t); };
@@ -0,0 +1,101 @@
+// Host check of the LCD framebuffer (src/display_handler.cpp):
+//   make -C tools check-lcd
+// The controller is emulated as an HD44780: DDRAM address counter with the
+// 20x4 row offsets, CGRAM mode after createChar until the next setCursor.
+// Checks that no character lands in CGRAM, that the screen after many
+// incremental flushes equals a fresh full render (characters and glyphs) and
+// that redrawing an unchanged screen sends nothing.
+
+#include "display_handler.h"
+#include <stdio.h>
+
+static uint8_t ddram[128];
+static uint8_t cgram[8][8];
+static uint8_t address = 0;
+static bool cgramMode = false;
+static unsigned long bytes = 0;       // I2C bytes, one per command or character
+static unsigned long cgramWrites = 0;
+static const uint8_t rowOffsets[4] = {0x00, 0x40, 0x14, 0x54};
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t, uint8_t, uint8_t) {}
+void LiquidCrystal_I2C::init() {}
+void LiquidCrystal_I2C::backlight() {}
+void LiquidCrystal_I2C::clear() { memset(ddram, ' ', sizeof(ddram)); address = 0; cgramMode = false; bytes++; }
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row) { address = rowOffsets[row] + col; cgramMode = false; bytes++; }
+void LiquidCrystal_I2C::createChar(uint8_t slot, uint8_t* rows) { memcpy(cgram[slot & 7], rows, 8); cgramMode = true; bytes += 9; }
+size_t Print::write(uint8_t c) {
+    if (cgramMode) cgramWrites++;
+    else ddram[address++ & 0x7F] = c;
+    bytes++;
+    return 1;
+}
+
+TwoWire Wire;
+void TwoWire::begin() {}
+void TwoWire::setClock(uint32_t) {}
+
+static unsigned long now = 0;
+unsigned long millis() { return now; }
+void delay(unsigned long) {}
+void pinMode(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return HIGH; }
+void digitalWrite(uint8_t, uint8_t) {}
+void ledcSetup(uint8_t, double, uint8_t) {}
+void ledcWriteTone(uint8_t, double) {}
+void ledcAttachPin(uint8_t, uint8_t) {}
+void ledcDetachPin(uint8_t) {}
+const AlarmRule alarmRules[ALARM_TYPES] = {};
+
+static bool check(const char* name, bool ok) {
+    printf("%-32s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main() {
+    DisplayHandler display;
+    display.begin();
+    FrequencyAnalysis analysis{};
+    analysis.isValidSignal = true;
+
+    unsigned long worst = 0, total = 0;
+    const int refreshes = 2000;
+    for (int k = 0; k < refreshes; k++) {
+        analysis.frequency = TARGET_FREQUENCY + 0.15 * sin(k * 0.01) + 0.001 * (k % 7);
+        display.updateAnalysis(analysis);
+        if (k == 50) display.updateWifiStatus(true);
+        if (k == 600) {
+            AlarmEvent event{};
+            event.phase = ALARM_EVENT_START;
+            event.start.tv_sec = 1700000000;
+            snprintf(event.message, sizeof(event.message), "Freq low");
+            display.addEvent(event);
+        }
+        if (k == 900) display.handleMuteButton();
+        unsigned long before = bytes;
+        now += 250;
+        display.loop();
+        worst = max(worst, bytes - before);
+        total += bytes - before;
+    }
+    printf("I2C bytes per refresh: %.1f average, %lu worst\n", (double)total / refreshes, worst);
+
+    unsigned long before = bytes;
+    display.updateAnalysis(analysis);
+    now += 250;
+    display.loop();
+    bool steady = bytes == before;
+
+    uint8_t shown[sizeof(ddram)], shownGlyphs[sizeof(cgram)];
+    memcpy(shown, ddram, sizeof(ddram));
+    memcpy(shownGlyphs, cgram, sizeof(cgram));
+    DisplayHandler fresh;
+    fresh.begin();
+    fresh.updateWifiStatus(true);
+    fresh.updateAnalysis(analysis);
+    fresh.loop();
+    bool ok = check("no writes in CGRAM mode", cgramWrites == 0);
+    ok &= check("unchanged screen sends nothing", steady);
+    ok &= check("matches a full render", memcmp(shown, ddram, sizeof(ddram)) == 0
+                                         && memcmp(shownGlyphs, cgram, sizeof(cgram)) == 0);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Read the sensor's live server (LIVE_SERVER 1) without the MQTT broker.
+
+    ./live_client.py 192.168.1.50              measurements as JSON lines
+    ./live_client.py 192.168.1.50 --raw        plus ADC frames (one summary line each)
+    ./live_client.py 192.168.1.50 --status     /status once
+    ./live_client.py localhost --port 18080 --count 20   (host build: make -C tools live_host)
+
+Standard library only; frames are decoded per RFC 6455.
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import os
+import socket
+import struct
+import sys
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+def http_get(host, port, path):
+    with socket.create_connection((host, port), timeout=10) as s:
+        s.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n" % (path, host)).encode())
+        data = b""
+        while True:
+            chunk = s.recv(4096)
+            if not chunk:
+                break
+            data += chunk
+    head, _, body = data.partition(b"\r\n\r\n")
+    return head.decode().split("\r\n")[0], body
+
+
+class WebSocket:
+    def __init__(self, host, port, path):
+        self.sock = socket.create_connection((host, port), timeout=10)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                           "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n" % (path, host, key)).encode())
+        self.buffer = b""
+        while b"\r\n\r\n" not in self.buffer:
+            self.buffer += self.recv()
+        head, _, self.buffer = self.buffer.partition(b"\r\n\r\n")
+        lines = head.decode().split("\r\n")
+        if " 101 " not in lines[0]:
+            raise RuntimeError("handshake failed: " + lines[0])
+        expected = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        headers = dict(line.split(": ", 1) for line in lines[1:])
+        if headers.get("Sec-WebSocket-Accept") != expected:
+            raise RuntimeError("bad Sec-WebSocket-Accept")
+
+    def recv(self):
+        chunk = self.sock.recv(4096)
+        if not chunk:
+            raise EOFError("connection closed")
+        return chunk
+
+    def take(self, n):
+        while len(self.buffer) < n:
+            self.buffer += self.recv()
+        data, self.buffer = self.buffer[:n], self.buffer[n:]
+        return data
+
+    def frame(self):
+        b0, b1 = self.take(2)
+        length = b1 & 0x7F
+        if length == 126:
+            length = struct.unpack(">H", self.take(2))[0]
+        elif length == 127:
+            length = struct.unpack(">Q", self.take(8))[0]
+        return b0 & 0x0F, self.take(length)
+
+    def send(self, opcode, payload=b""):
+        mask = os.urandom(4)
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        self.sock.sendall(bytes([0x80 | opcode, 0x80 | len(payload)]) + mask + masked)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--raw", action="store_true", help="also receive ADC frames")
+    parser.add_argument("--status", action="store_true", help="print /status and exit")
+    parser.add_argument("--count", type=int, default=0, help="stop after this many frames")
+    args = parser.parse_args()
+
+    if args.status:
+        line, body = http_get(args.host, args.port, "/status")
+        if " 200 " not in line:
+            sys.exit(line)
+        print(json.dumps(json.loads(body), indent=1))
+        return
+
+    ws = WebSocket(args.host, args.port, "/ws?raw=1" if args.raw else "/ws")
+    frames = 0
+    while not args.count or frames < args.count:
+        opcode, payload = ws.frame()
+        if opcode == 0x1:
+            print(payload.decode())
+        elif opcode == 0x2:
+            index, count, bits = struct.unpack_from("<IHB", payload)
+            samples = struct.unpack_from("<%dH" % count, payload, 12)
+            print(json.dumps({"raw": index, "count": count, "bits": bits, "min": min(samples), "max": max(samples)}))
+        elif opcode == 0x8:
+            break
+        frames += 1
+    ws.send(0x8, struct.pack(">H", 1000))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,93 @@
+// Host build of the live server (src/live_server.cpp) for testing without a
+// sensor. Serves a synthetic signal at the device's slice rate:
+//   make -C tools live_host
+//   tools/build/live_host [port]                  (default 18080)
+//   tools/live_client.py localhost --port 18080 [--raw | --status]
+
+#include "live_server.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOST_SAMPLE_BITS 12           // Raw frames as from the plain 12-bit ADC
+#define HOST_RAW_SIZE (12 + 2 * PHASE_BLOCK_SIZE)  // PAYLOAD_RAW_SIZE
+#define SLICE_MS (1000 * PHASE_BLOCK_SIZE / SAMPLING_FREQUENCY)
+
+static volatile sig_atomic_t running = 1;
+static unsigned long startMs;
+static uint32_t sampleIndex = 0;
+static double frequency = TARGET_FREQUENCY;
+
+static unsigned long nowMs() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+static size_t formatStatus(char* out, size_t size) {
+    int len = snprintf(out, size,
+                       "{\"sensorId\":\"%s\",\"uptime\":%lu,\"analysis\":{\"freq\":%.4f,\"valid\":true},"
+                       "\"alarms\":[],\"host\":true}",
+                       SENSOR_ID, (nowMs() - startMs) / 1000, frequency);
+    return len > 0 && (size_t)len < size ? len : 0;
+}
+
+// Little-endian, same layout as encodeRawFrame()
+static size_t encodeRaw(uint8_t* out) {
+    uint8_t* p = out;
+    for (uint8_t i = 0; i < 4; i++) *p++ = sampleIndex >> (8 * i);
+    *p++ = PHASE_BLOCK_SIZE & 0xFF;
+    *p++ = PHASE_BLOCK_SIZE >> 8;
+    *p++ = HOST_SAMPLE_BITS;
+    *p++ = 0;
+    for (uint8_t i = 0; i < 4; i++) *p++ = (uint32_t)SAMPLING_FREQUENCY >> (8 * i);
+    for (uint16_t i = 0; i < PHASE_BLOCK_SIZE; i++) {
+        double t = (double)(sampleIndex - PHASE_BLOCK_SIZE + i) / SAMPLING_FREQUENCY;
+        uint16_t sample = (uint16_t)lround(2048 + 1500 * sin(2 * M_PI * frequency * t));
+        *p++ = sample & 0xFF;
+        *p++ = sample >> 8;
+    }
+    return p - out;
+}
+
+static void stop(int) { running = 0; }
+
+int main(int argc, char** argv) {
+    uint16_t port = argc > 1 ? atoi(argv[1]) : 18080;
+    LiveServer server(formatStatus);
+    if (!server.begin(port)) {
+        perror("live_host: begin");
+        return 1;
+    }
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    printf("live_host: http://localhost:%u/ (%s)\n", port, SENSOR_ID);
+    fflush(stdout);
+
+    startMs = nowMs();
+    unsigned long nextSlice = startMs;
+    while (running) {
+        unsigned long now = nowMs();
+        if ((long)(now - nextSlice) >= 0) {
+            nextSlice += SLICE_MS;
+            sampleIndex += PHASE_BLOCK_SIZE;
+            frequency = TARGET_FREQUENCY + 0.05 * sin(sampleIndex / (10.0 * SAMPLING_FREQUENCY));
+
+            char json[160];
+            int len = snprintf(json, sizeof(json), "{\"sensorId\":\"%s\",\"time\":%lu,\"freq\":%.3f,\"amp\":%.1f,\"quality\":%.3f}",
+                               SENSOR_ID, now - startMs, frequency, 1500.0, 0.0);
+            server.broadcast(json, len);
+            if (server.hasRawClients()) {
+                uint8_t raw[HOST_RAW_SIZE];
+                server.broadcastRaw(raw, encodeRaw(raw));
+            }
+        }
+        server.poll(now);
+        usleep(2000);
+    }
+    printf("live_host: %lu frames dropped\n", (unsigned long)server.getDrops());
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Host round trip of src/payload_codec.cpp against decode_payload.py:
+//   make -C tools check-payload
+// Prints one JSON line per case: the payload (hex) and the values that were
+// encoded; check_payload.py decodes the payload and compares.
+
+#include "payload_codec.h"
+#include <stdio.h>
+
+unsigned long millis() { return 0; }
+
+static bool first;
+
+static void field(const char* name, double value) {
+    printf(isfinite(value) ? "%s\"%s\":%.17g" : "%s\"%s\":null", first ? "" : ",", name, value);
+    first = false;
+}
+
+static void list(const char* name, const float* values, uint8_t count) {
+    printf("%s\"%s\":[", first ? "" : ",", name);
+    for (uint8_t i = 0; i < count; i++) printf(isfinite(values[i]) ? "%s%.17g" : "%snull", i ? "," : "", values[i]);
+    printf("]");
+    first = false;
+}
+
+static void hex(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) printf("%02x", data[i]);
+}
+
+static void expectMeasurement(const FrequencyAlert& a, const SystemMetrics& m) {
+    const FrequencyAnalysis& f = a.frequencyAnalysis;
+    first = true;
+    printf("{");
+    field("time", (double)f.time.tv_sec * 1000 + f.time.tv_usec / 1000);
+    field("freq", f.frequency);
+    field("freqCoarse", f.coarseFrequency);
+    field("freqFll", f.fllFrequency);
+    field("amp", f.amplitude);
+    field("quality", f.quality);
+    field("ramp", a.ramp);
+    list("rocof", a.rocof, ROCOF_WINDOWS);
+    field("rocofStd", f.rocofSigma);
+    field("thd", f.harmonicsValid ? f.thd : NAN);
+    if (f.harmonicsValid) {
+        float harm[HARMONIC_MAX - 1];
+        for (uint8_t h = 0; h < HARMONIC_MAX - 1; h++) harm[h] = f.harmonics[h];
+        list("harm", harm, HARMONIC_MAX - 1);
+    }
+    field("analyzingDelay", a.analyzingDelay);
+    field("clockPpm", f.clockPpm);
+    field("freeHeap", m.freeHeap);
+    field("heapUsage", m.heapUsage);
+    field("cpuFreq", m.cpuFreq);
+    field("wifiRSSI", m.rssi);
+    printf("}");
+}
+
+static FrequencyAlert measurement(uint32_t n) {
+    FrequencyAlert a{};
+    FrequencyAnalysis& f = a.frequencyAnalysis;
+    f.time.tv_sec = 1761407894 + n / 4;
+    f.time.tv_usec = (n % 4) * 250000;
+    f.frequency = TARGET_FREQUENCY - 0.035877 + 0.0013 * n;
+    f.coarseFrequency = f.frequency + 0.003;
+    f.fllFrequency = f.frequency - 0.0009;
+    f.amplitude = 167844 + 31 * n;
+    f.quality = 0.0123;
+    f.isValidSignal = true;
+    f.fineValid = true;
+    f.harmonicsValid = true;
+    f.thd = 2.41;
+    for (uint8_t h = 0; h < HARMONIC_MAX - 1; h++) f.harmonics[h] = 0.12 + h * 0.9;
+    f.rocofSigma = 0.0121;
+    f.clockPpm = -4.21;
+    a.ramp = -0.00299;
+    for (uint8_t w = 0; w < ROCOF_WINDOWS; w++) a.rocof[w] = 0.0124 - 0.0031 * w;
+    a.analyzingDelay = 250;
+    return a;
+}
+
+int main() {
+    SystemMetrics metrics{111228, 65.4f, 240, -60};
+    uint8_t out[2 * PAYLOAD_BINARY_SIZE];
+
+    // Version 1, all fields measured
+    FrequencyAlert a = measurement(0);
+    size_t n = encodeMeasurement(a, metrics, out, sizeof(out));
+    printf("{\"case\":\"measurement\",\"hex\":\"");
+    hex(out, n);
+    printf("\",\"expect\":");
+    expectMeasurement(a, metrics);
+    printf("}\n");
+
+    // Version 1, estimators failing: NaN and inf become missing codes (u32 fields 0)
+    FrequencyAlert bad = measurement(1);
+    bad.frequencyAnalysis.fllFrequency = NAN;
+    bad.frequencyAnalysis.quality = INFINITY;
+    bad.frequencyAnalysis.thd = NAN;
+    bad.frequencyAnalysis.harmonics[0] = -INFINITY;
+    bad.frequencyAnalysis.clockPpm = NAN;
+    bad.ramp = NAN;
+    bad.rocof[0] = INFINITY;
+    n = encodeMeasurement(bad, metrics, out, sizeof(out));
+    bad.frequencyAnalysis.fllFrequency = 0;
+    printf("{\"case\":\"non-finite\",\"hex\":\"");
+    hex(out, n);
+    printf("\",\"expect\":");
+    expectMeasurement(bad, metrics);
+    printf("}\n");
+
+    // Backfill: version 1 records back to back
+    FrequencyAlert b = measurement(2);
+    n = encodeMeasurement(a, metrics, out, sizeof(out));
+    n += encodeMeasurement(b, metrics, out + n, sizeof(out) - n);
+    printf("{\"case\":\"records\",\"hex\":\"");
+    hex(out, n);
+    printf("\",\"expect\":{\"records\":[");
+    expectMeasurement(a, metrics);
+    printf(",");
+    expectMeasurement(b, metrics);
+    printf("]}}\n");
+
+    // Version 2 batch on the interval grid; a NaN sample goes out as nominal / 0
+    BatchEncoder batch;
+    FrequencyAlert samples[5];
+    for (uint8_t i = 0; i < 5; i++) {
+        uint32_t ms = i * PAYLOAD_BATCH_INTERVAL_MS;
+        samples[i] = measurement(i * RAW_PUBLISH_DIVIDER);
+        samples[i].frequencyAnalysis.time.tv_sec = 1761407894 + ms / 1000;
+        samples[i].frequencyAnalysis.time.tv_usec = (ms % 1000) * 1000;
+    }
+    samples[3].frequencyAnalysis.frequency = NAN;
+    samples[3].frequencyAnalysis.amplitude = NAN;
+    for (uint8_t i = 0; i < 5; i++) batch.add(samples[i]);
+    uint8_t batchOut[PAYLOAD_BATCH_HEADER + BATCH_SIZE * PAYLOAD_BATCH_SAMPLE_MAX];
+    n = batch.finish(metrics, batchOut, sizeof(batchOut));
+    printf("{\"case\":\"batch\",\"hex\":\"");
+    hex(batchOut, n);
+    printf("\",\"expect\":{\"samples\":[");
+    for (uint8_t i = 0; i < 5; i++) {
+        const FrequencyAnalysis& f = samples[i].frequencyAnalysis;
+        first = true;
+        printf("%s{", i ? "," : "");
+        field("time", (double)f.time.tv_sec * 1000 + f.time.tv_usec / 1000);
+        field("freq", isfinite(f.frequency) ? f.frequency : TARGET_FREQUENCY);
+        field("amp", isfinite(f.amplitude) ? f.amplitude : 0);
+        printf("}");
+    }
+    printf("]}}\n");
+    return 0;
+}
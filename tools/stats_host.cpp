@@ -0,0 +1,83 @@
+// Host check of the interval statistics (src/stream_stats.cpp):
+//   make -C tools check-stats
+// P-square quantiles must be exact up to five samples; intervals must not
+// be published before SNTP or across a clock step.
+
+#include "stream_stats.h"
+#include <stdio.h>
+
+static const uint16_t intervals[STATS_INTERVAL_COUNT] = STATS_INTERVALS;
+static StreamStats stats;
+static StatsSummary published[64];
+static uint8_t publishedCount = 0;
+
+static bool check(const char* name, bool ok) {
+    printf("%-40s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Four slices per second from start, as the analysis task stamps them
+static void feed(time_t start, uint32_t seconds) {
+    StatsSummary closed[STATS_INTERVAL_COUNT];
+    for (uint32_t n = 0; n < 4 * seconds; n++) {
+        FrequencyAnalysis analysis{};
+        analysis.time.tv_sec = start + n / 4;
+        analysis.time.tv_usec = (n % 4) * 250000;
+        analysis.isValidSignal = true;
+        analysis.frequency = TARGET_FREQUENCY + 0.01 * (n % 5);
+        uint8_t count = stats.update(analysis, closed);
+        for (uint8_t k = 0; k < count && publishedCount < 64; k++) published[publishedCount++] = closed[k];
+    }
+}
+
+static bool wasPublished(time_t start, uint16_t interval) {
+    for (uint8_t k = 0; k < publishedCount; k++) {
+        if (published[k].start == start && published[k].interval == interval) return true;
+    }
+    return false;
+}
+
+int main() {
+    bool ok = true;
+
+    P2Quantile low, median, high;
+    low.begin(0.05f);
+    median.begin(0.5f);
+    high.begin(0.95f);
+    const double samples[5] = {3, 1, 5, 2, 4};
+    for (uint8_t i = 0; i < 3; i++) median.add(samples[i]);
+    ok &= check("P2 median of three samples", median.value() == 3);
+    for (uint8_t i = 0; i < 5; i++) {
+        low.add(samples[i]);
+        high.add(samples[i]);
+    }
+    ok &= check("P2 5 %/95 % of five samples", low.value() == 1 && high.value() == 5);
+
+    // Boot on the 1970 clock
+    feed(100, 200);
+    ok &= check("nothing published before SNTP", publishedCount == 0);
+
+    // SNTP sets the time 30 s into an interval
+    time_t base = STATS_VALID_TIME + 100000;
+    base -= base % intervals[STATS_INTERVAL_COUNT - 1];
+    feed(base + 30, 130);
+    ok &= check("first intervals after SNTP", publishedCount == 2
+                                              && published[0].start == base && published[0].count == 4 * 30
+                                              && published[1].start == base + 60 && published[1].count == 4 * 60);
+
+    // Step back 5 min: the open intervals must not be published
+    time_t open[STATS_INTERVAL_COUNT];
+    for (uint8_t i = 0; i < STATS_INTERVAL_COUNT; i++) open[i] = (base + 160) - (base + 160) % intervals[i];
+    feed(base + 160 - 300, 70);
+    // and forward by more than an interval
+    feed(base + 1000, 70);
+    bool discarded = true;
+    for (uint8_t i = 0; i < STATS_INTERVAL_COUNT; i++) discarded &= !wasPublished(open[i], intervals[i]);
+    bool bounded = true;
+    for (uint8_t k = 0; k < publishedCount; k++) {
+        bounded &= published[k].start % published[k].interval == 0 && published[k].count <= 4u * published[k].interval;
+    }
+    ok &= check("open intervals discarded on a step", discarded);
+    ok &= check("published intervals aligned and bounded", bounded);
+    return ok ? 0 : 1;
+}